@@ -0,0 +1,297 @@
+#include "bench.h"
+#include "bmp8.h"
+#include "bmp24.h"
+#include "histogram.h"
+#include "components.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Traitement mesuré : une seule des deux fonctions est renseignée
+typedef struct {
+    const char *name;
+    void (*run8)(t_bmp8 *img);
+    void (*run24)(t_bmp24 *img);
+    int binary;             // run8 reçoit l'image binarisée au lieu du dégradé
+} t_benchCase;
+
+// Positionné par un traitement qui n'a pas pu s'exécuter (allocation)
+static int bench_failed = 0;
+
+static double bench_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1e6;
+}
+
+// Noyau gaussien size x size (coefficients binomiaux), normalisé, NULL en
+// cas d'échec d'allocation
+static float **bench_gaussianKernel(int size) {
+    float **kernel = (float **)malloc(size * sizeof(float *));
+    if (!kernel) return NULL;
+    float weights[32];
+    weights[0] = 1.0f;
+    for (int i = 1; i < size; i++) {
+        weights[i] = 1.0f;
+        for (int j = i - 1; j > 0; j--) weights[j] += weights[j - 1];
+    }
+    float total = 0.0f;
+    for (int i = 0; i < size; i++) total += weights[i];
+    for (int y = 0; y < size; y++) {
+        kernel[y] = (float *)malloc(size * sizeof(float));
+        if (!kernel[y]) {
+            while (y > 0) free(kernel[--y]);
+            free(kernel);
+            return NULL;
+        }
+        for (int x = 0; x < size; x++) kernel[y][x] = weights[y] * weights[x] / (total * total);
+    }
+    return kernel;
+}
+
+static void bench_filter8(t_bmp8 *img, int size) {
+    float **kernel = bench_gaussianKernel(size);
+    if (!kernel) {
+        bench_failed = 1;
+        return;
+    }
+    bmp8_applyFilter(img, kernel, size);
+    for (int i = 0; i < size; i++) free(kernel[i]);
+    free(kernel);
+}
+
+static void bench_gaussian5(t_bmp8 *img) {
+    bench_filter8(img, 5);
+}
+
+static void bench_gaussian15(t_bmp8 *img) {
+    bench_filter8(img, 15);
+}
+
+static void bench_clahe8(t_bmp8 *img) {
+    bmp8_clahe(img, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_CLIP);
+}
+
+static void bench_clahe24(t_bmp24 *img) {
+    bmp24_clahe(img, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_CLIP);
+}
+
+// Opérations ponctuelles : avec la palette de gris, seules les 256
+// entrées de la table des couleurs sont réécrites
+static void bench_negative(t_bmp8 *img) {
+    bmp8_negative(img);
+}
+
+static void bench_brightness(t_bmp8 *img) {
+    bmp8_brightness(img, 20);
+}
+
+static void bench_threshold(t_bmp8 *img) {
+    bmp8_threshold(img, 128);
+}
+
+static void bench_pointChain(t_bmp8 *img) {
+    bmp8_negative(img);
+    bmp8_brightness(img, 20);
+    bmp8_threshold(img, 128);
+}
+
+// Même chaîne puis application aux pixels : une passe sur l'image
+static void bench_pointChainApplied(t_bmp8 *img) {
+    bench_pointChain(img);
+    bmp8_applyPalette(img);
+}
+
+static const t_benchCase bench_pointCases[] = {
+    {"Negatif", bench_negative, NULL, 0},
+    {"Luminosite +20", bench_brightness, NULL, 0},
+    {"Seuil 128", bench_threshold, NULL, 0},
+    {"Negatif + luminosite + seuil", bench_pointChain, NULL, 0},
+    {"... puis bmp8_applyPalette", bench_pointChainApplied, NULL, 0},
+};
+
+static void bench_label(t_bmp8 *img, t_connectivity connectivity) {
+    t_components *components = components_label(img, connectivity);
+    if (!components) bench_failed = 1;
+    components_free(components);
+}
+
+static void bench_components4(t_bmp8 *img) {
+    bench_label(img, COMPONENTS_4);
+}
+
+static void bench_components8(t_bmp8 *img) {
+    bench_label(img, COMPONENTS_8);
+}
+
+static const t_benchCase bench_cases[] = {
+    {"Convolution 8 bits 5x5", bench_gaussian5, NULL, 0},
+    {"Convolution 8 bits 15x15 (FFT)", bench_gaussian15, NULL, 0},
+    {"Convolution 24 bits 3x3", NULL, bmp24_gaussianBlur, 0},
+    {"CLAHE 8 bits", bench_clahe8, NULL, 0},
+    {"CLAHE 24 bits", NULL, bench_clahe24, 0},
+    {"Composantes 4-connexes", bench_components4, NULL, 1},
+    {"Composantes 8-connexes", bench_components8, NULL, 1},
+};
+
+/**
+ * Durée d'un traitement sur une copie fraîche de l'image (copie non comptée)
+ * @return Durée en ms, -1 en cas d'échec d'allocation
+ */
+static double bench_time(const t_benchCase *c, const t_bmp8 *source8, const t_bmp8 *binary, const t_bmp24 *source24) {
+    double start;
+    double elapsed;
+    if (c->run8) {
+        t_bmp8 *img = bmp8_copy(c->binary ? binary : source8);
+        if (!img) return -1;
+        start = bench_now();
+        c->run8(img);
+        elapsed = bench_now() - start;
+        bmp8_free(img);
+    } else {
+        t_bmp24 *img = bmp24_copy(source24);
+        if (!img) return -1;
+        start = bench_now();
+        c->run24(img);
+        elapsed = bench_now() - start;
+        bmp24_free(img);
+    }
+    if (bench_failed) {
+        bench_failed = 0;
+        return -1;
+    }
+    return elapsed;
+}
+
+static int bench_compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Médiane de BENCH_REPEAT mesures d'un traitement 8 bits
+ * @return Durée en ms, -1 en cas d'échec d'allocation
+ */
+static double bench_median8(const t_benchCase *c, const t_bmp8 *source) {
+    double times[BENCH_REPEAT];
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        times[r] = bench_time(c, source, source, NULL);
+        if (times[r] < 0) return -1;
+    }
+    qsort(times, BENCH_REPEAT, sizeof(double), bench_compareDouble);
+    return times[BENCH_REPEAT / 2];
+}
+
+/**
+ * Opérations ponctuelles 8 bits sur l'image entière puis sur son coin de
+ * (width / 4) x (height / 4) pixels : hors application aux pixels, la
+ * durée ne dépend pas de la taille de l'image
+ * @return 0 si succès, -1 en cas d'échec d'allocation
+ */
+static int bench_pointOps(const t_bmp8 *source8) {
+    int width = (int)source8->width;
+    int height = (int)source8->height;
+    t_bmp8 *small = bmp8_allocate(width / 4, height / 4);
+    if (!small) return -1;
+    for (int y = 0; y < height / 4; y++) {
+        memcpy(small->data + (size_t)y * (width / 4), source8->data + (size_t)y * width, width / 4);
+    }
+
+    printf("\n--- Operations ponctuelles 8 bits (table des couleurs) ---\n");
+    printf("Images %dx%d et %dx%d (16 fois moins de pixels), mediane de %d mesures\n",
+           width, height, width / 4, height / 4, BENCH_REPEAT);
+    printf("%-32s %12s %14s %8s\n", "Traitement", "grande (ms)", "petite (ms)", "rapport");
+
+    int status = 0;
+    for (size_t i = 0; i < sizeof(bench_pointCases) / sizeof(bench_pointCases[0]); i++) {
+        const t_benchCase *c = &bench_pointCases[i];
+        double a = bench_median8(c, source8);
+        double b = bench_median8(c, small);
+        if (a < 0 || b < 0) {
+            status = -1;
+            break;
+        }
+        printf("%-32s %12.4f %14.4f %8.2f\n", c->name, a, b, b > 0 ? a / b : 0.0);
+    }
+
+    bmp8_free(small);
+    return status;
+}
+
+/**
+ * Compare le pool à vol de tâches et la répartition statique
+ * @param width Largeur des images de test
+ * @param height Hauteur des images de test
+ * @return 0 si succès, -1 en cas d'échec d'allocation
+ */
+int bench_run(int width, int height) {
+    t_bmp8 *source8 = bmp8_allocate(width, height);
+    t_bmp8 *binary = bmp8_allocate(width, height);
+    t_bmp24 *source24 = bmp24_allocate(width, height, 24);
+    if (!source8 || !binary || !source24) {
+        printf("Erreur : Allocation memoire echouee pour les images de test\n");
+        bmp8_free(source8);
+        bmp8_free(binary);
+        bmp24_free(source24);
+        return -1;
+    }
+
+    // Dégradé bruité, pour que CLAHE et les filtres travaillent sur des
+    // valeurs variées (générateur congruentiel : mesures reproductibles)
+    unsigned int seed = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            seed = seed * 1103515245u + 12345u;
+            int noise = (int)((seed >> 16) & 63) - 32;
+            int base = (x * 255 / width + y * 128 / height) / 2 + noise;
+            unsigned char v = (unsigned char)(base < 0 ? 0 : base > 255 ? 255 : base);
+            source8->data[(size_t)y * width + x] = v;
+            source24->data[y][x] = (t_pixel){v, (uint8_t)(255 - v), (uint8_t)(v / 2 + 64)};
+        }
+    }
+
+    // Bruit binarisé à 45 % de premier plan : proche du seuil de
+    // percolation, c'est le pire cas en nombre d'étiquettes provisoires
+    for (size_t i = 0; i < binary->dataSize; i++) {
+        seed = seed * 1103515245u + 12345u;
+        binary->data[i] = ((seed >> 16) % 100) < 45 ? 255 : 0;
+    }
+
+    printf("\n--- Ordonnancement : vol de taches / repartition statique ---\n");
+    printf("Image %dx%d, %d threads, mediane de %d mesures\n", width, height, threadpool_threadCount(), BENCH_REPEAT);
+    printf("%-32s %12s %14s %8s\n", "Traitement", "vol (ms)", "statique (ms)", "rapport");
+
+    int status = 0;
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]) && status == 0; i++) {
+        const t_benchCase *c = &bench_cases[i];
+        double stealing[BENCH_REPEAT];
+        double fixed[BENCH_REPEAT];
+
+        // Mesures alternées, pour que les deux modes subissent la même dérive
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            threadpool_setStaticPartition(0);
+            stealing[r] = bench_time(c, source8, binary, source24);
+            threadpool_setStaticPartition(1);
+            fixed[r] = bench_time(c, source8, binary, source24);
+            if (stealing[r] < 0 || fixed[r] < 0) status = -1;
+        }
+        threadpool_setStaticPartition(0);
+        if (status != 0) break;
+
+        qsort(stealing, BENCH_REPEAT, sizeof(double), bench_compareDouble);
+        qsort(fixed, BENCH_REPEAT, sizeof(double), bench_compareDouble);
+        double a = stealing[BENCH_REPEAT / 2];
+        double b = fixed[BENCH_REPEAT / 2];
+        printf("%-32s %12.1f %14.1f %8.2f\n", c->name, a, b, a > 0 ? b / a : 0.0);
+    }
+    if (status == 0) status = bench_pointOps(source8);
+    if (status != 0) printf("Erreur : Allocation memoire echouee pendant les mesures\n");
+
+    bmp8_free(source8);
+    bmp8_free(binary);
+    bmp24_free(source24);
+    return status;
+}
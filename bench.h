@@ -0,0 +1,20 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Mesure comparative de l'ordonnancement : chaque traitement parallélisé
+// (convolutions directes et FFT, CLAHE, composantes connexes) est
+// chronométré avec le pool à vol de tâches puis avec une répartition
+// statique des lignes (height / nThreads par thread, threads créés à
+// chaque appel). Les opérations ponctuelles 8 bits sont ensuite mesurées
+// sur deux tailles d'image, pour vérifier que leur coût ne dépend pas du
+// nombre de pixels. Les images de test sont synthétiques ;
+// PROJETC_THREADS fixe le nombre de threads.
+
+#define BENCH_DEFAULT_WIDTH 2048
+#define BENCH_DEFAULT_HEIGHT 2048
+#define BENCH_REPEAT 5              // mesures par traitement, médiane retenue
+
+// Affiche le tableau des temps. Retourne 0 si succès.
+int bench_run(int width, int height);
+
+#endif // BENCH_H
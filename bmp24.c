@@ -1,4 +1,9 @@
 #include "bmp24.h"
+#include "bmpheader.h"
+#include "histogram.h"
+#include "fft.h"
+#include "profile.h"
+#include "threadpool.h"
 #include <string.h> // Pour memset
 #include <math.h>
 
@@ -11,6 +16,7 @@
 t_pixel **bmp24_allocateDataPixels(int width, int height) {
     t_pixel **pixels = (t_pixel **)malloc(height * sizeof(t_pixel *));
     if (!pixels) return NULL;
+    PROFILE_ALLOC(height * sizeof(t_pixel *));
 
     for (int i = 0; i < height; i++) {
         pixels[i] = (t_pixel *)malloc(width * sizeof(t_pixel));
@@ -19,6 +25,7 @@ t_pixel **bmp24_allocateDataPixels(int width, int height) {
             free(pixels);
             return NULL;
         }
+        PROFILE_ALLOC(width * sizeof(t_pixel));
     }
     return pixels;
 }
@@ -36,6 +43,29 @@ void bmp24_freeDataPixels(t_pixel **pixels, int height) {
     free(pixels);
 }
 
+/**
+ * Remplit les en-têtes d'un fichier BMP non compressé à partir des
+ * dimensions de l'image, pour qu'elle puisse être sauvegardée telle quelle
+ * @param img Image dont width, height et colorDepth sont renseignés
+ */
+void bmp24_initHeaders(t_bmp24 *img) {
+    int padding = (4 - (img->width * 3) % 4) % 4;
+    uint32_t imageSize = (uint32_t)(img->width * 3 + padding) * img->height;
+    memset(&img->header, 0, sizeof(t_bmp_header));
+    memset(&img->header_info, 0, sizeof(t_bmp_info));
+    img->header.type = 0x4D42; // "BM"
+    img->header.offset = sizeof(t_bmp_header) + sizeof(t_bmp_info);
+    img->header.size = img->header.offset + imageSize;
+    img->header_info.size = sizeof(t_bmp_info);
+    img->header_info.width = img->width;
+    img->header_info.height = img->height;
+    img->header_info.planes = 1;
+    img->header_info.bits = img->colorDepth;
+    img->header_info.imagesize = imageSize;
+    img->header_info.xresolution = 2835; // 72 dpi
+    img->header_info.yresolution = 2835;
+}
+
 /**
  * Alloue une structure BMP24 vide
  * @param width Largeur de l'image
@@ -50,6 +80,7 @@ t_bmp24 *bmp24_allocate(int width, int height, int colorDepth) {
     img->width = width;
     img->height = height;
     img->colorDepth = colorDepth;
+    bmp24_initHeaders(img);
 
     img->data = bmp24_allocateDataPixels(width, height);
     if (!img->data) {
@@ -60,6 +91,27 @@ t_bmp24 *bmp24_allocate(int width, int height, int colorDepth) {
     return img;
 }
 
+/**
+ * Duplique une image BMP24 (en-têtes et pixels)
+ * @param img Image à copier
+ * @return Copie indépendante, NULL en cas d'échec
+ */
+t_bmp24 *bmp24_copy(const t_bmp24 *img) {
+    if (!img || !img->data) return NULL;
+    t_bmp24 *copy = (t_bmp24 *)malloc(sizeof(t_bmp24));
+    if (!copy) return NULL;
+    *copy = *img;
+    copy->data = bmp24_allocateDataPixels(img->width, img->height);
+    if (!copy->data) {
+        free(copy);
+        return NULL;
+    }
+    for (int i = 0; i < img->height; i++) {
+        memcpy(copy->data[i], img->data[i], img->width * sizeof(t_pixel));
+    }
+    return copy;
+}
+
 /**
  * Libère complètement une image BMP24
  * @param img Pointeur vers l'image à libérer
@@ -76,47 +128,165 @@ void bmp24_free(t_bmp24 *img) {
  * @return Pointeur vers l'image chargée, NULL en cas d'erreur
  */
 t_bmp24 *bmp24_loadImage(const char *filename) {
+    return bmp24_loadImageReuse(filename, NULL);
+}
+
+/**
+ * Charge une image BMP 24 bits en réutilisant si possible une image déjà
+ * allouée : si ses dimensions correspondent, les pixels sont lus dans ses
+ * lignes existantes, sinon elle est libérée et une nouvelle image est créée
+ * @param filename Chemin vers le fichier BMP
+ * @param spare Image à recycler (peut être NULL), prise en charge dans tous les cas
+ * @return Pointeur vers l'image chargée, NULL en cas d'erreur
+ */
+t_bmp24 *bmp24_loadImageReuse(const char *filename, t_bmp24 *spare) {
+    PROFILE_BEGIN(bmp24_loadImage);
     FILE *file = fopen(filename, "rb");
     if (!file) {
         printf("Erreur : impossible d'ouvrir %s\n", filename);
+        bmp24_free(spare);
+        PROFILE_END(bmp24_loadImage, 0);
         return NULL;
     }
 
-    t_bmp24 *img = (t_bmp24 *)malloc(sizeof(t_bmp24));
-    if (!img) return NULL;
+    // Validation complète de l'en-tête avant toute allocation
+    t_bmpFormat format;
+    t_bmpError error = bmpheader_read(file, &format);
+    if (error != BMP_OK || format.bits != 24) {
+        if (error != BMP_OK) printf("Erreur : fichier BMP invalide (%s) : %s\n", bmpheader_errorMessage(error), filename);
+        else printf("Erreur : l'image n'est pas en 24 bits.\n");
+        fclose(file);
+        bmp24_free(spare);
+        PROFILE_END(bmp24_loadImage, 0);
+        return NULL;
+    }
 
-    fread(&img->header, sizeof(t_bmp_header), 1, file);
-    fread(&img->header_info, sizeof(t_bmp_info), 1, file);
+    t_bmp24 *img = spare;
+    if (img && (img->width != format.width || img->height != format.height)) {
+        bmp24_free(img);
+        img = NULL;
+    }
+    if (!img) {
+        img = (t_bmp24 *)malloc(sizeof(t_bmp24));
+        if (!img) {
+            fclose(file);
+            PROFILE_END(bmp24_loadImage, 0);
+            return NULL;
+        }
+        img->data = bmp24_allocateDataPixels(format.width, format.height);
+        if (!img->data) {
+            fclose(file);
+            free(img);
+            PROFILE_END(bmp24_loadImage, 0);
+            return NULL;
+        }
+    }
 
-    if (img->header_info.bits != 24) {
-        printf("Erreur : l'image n'est pas en 24 bits.\n");
-        fclose(file);
-        free(img);
+    // En-têtes ramenés à la forme écrite par bmp24_saveImage (40 octets,
+    // pixels juste derrière) ; le signe de la hauteur est conservé
+    memcpy(&img->header, format.raw, sizeof(t_bmp_header));
+    memcpy(&img->header_info, format.raw + sizeof(t_bmp_header), sizeof(t_bmp_info));
+    img->width = format.width;
+    img->height = format.height;
+    img->colorDepth = 24;
+    img->header.offset = sizeof(t_bmp_header) + sizeof(t_bmp_info);
+    img->header.size = img->header.offset + (uint32_t)(format.stride * format.height);
+    img->header_info.size = sizeof(t_bmp_info);
+    img->header_info.imagesize = (uint32_t)(format.stride * format.height);
+
+    // Une lecture par ligne, dans l'ordre du fichier : un fichier de haut en
+    // bas est rangé directement à sa place, sans passe de retournement
+    unsigned char *buffer = (unsigned char *)malloc(format.stride);
+    int ok = buffer && fseek(file, format.dataOffset, SEEK_SET) == 0;
+    for (int r = 0; ok && r < img->height; r++) {
+        ok = fread(buffer, 1, format.stride, file) == format.stride;
+        t_pixel *row = img->data[bmpheader_rowAt(&format, r)];
+        for (int j = 0; ok && j < img->width; j++) {
+            row[j].blue = buffer[j * 3];
+            row[j].green = buffer[j * 3 + 1];
+            row[j].red = buffer[j * 3 + 2];
+        }
+    }
+    free(buffer);
+    fclose(file);
+    if (!ok) {
+        printf("Erreur : lecture des pixels impossible : %s\n", filename);
+        bmp24_free(img);
+        PROFILE_END(bmp24_loadImage, 0);
         return NULL;
     }
 
-    img->width = img->header_info.width;
-    img->height = img->header_info.height;
-    img->colorDepth = img->header_info.bits;
+    PROFILE_BYTES_READ(format.dataOffset + format.stride * img->height);
+    PROFILE_END(bmp24_loadImage, img->width * img->height);
+    return img;
+}
 
-    img->data = bmp24_allocateDataPixels(img->width, img->height);
-    if (!img->data) {
+/**
+ * Charge seulement une région d'une image BMP 24 bits : on ne lit du
+ * fichier que les lignes et colonnes qui la couvrent, le coût dépend donc
+ * de la taille de la région et non de celle de l'image
+ * @param filename Chemin vers le fichier BMP
+ * @param roi Région à charger (coordonnées de haut en bas, restreinte à l'image)
+ * @return Image de la taille de la région, NULL en cas d'erreur
+ */
+t_bmp24 *bmp24_loadImageRoi(const char *filename, t_roi roi) {
+    PROFILE_BEGIN(bmp24_loadImageRoi);
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Erreur : impossible d'ouvrir %s\n", filename);
+        PROFILE_END(bmp24_loadImageRoi, 0);
+        return NULL;
+    }
+
+    t_bmpFormat format;
+    t_bmpError error = bmpheader_read(file, &format);
+    if (error != BMP_OK || format.bits != 24) {
+        if (error != BMP_OK) printf("Erreur : fichier BMP invalide (%s) : %s\n", bmpheader_errorMessage(error), filename);
+        else printf("Erreur : l'image n'est pas en 24 bits.\n");
         fclose(file);
-        free(img);
+        PROFILE_END(bmp24_loadImageRoi, 0);
+        return NULL;
+    }
+    if (roi_clip(&roi, format.width, format.height) != 0) {
+        printf("Erreur : la region est en dehors de l'image %s\n", filename);
+        fclose(file);
+        PROFILE_END(bmp24_loadImageRoi, 0);
         return NULL;
     }
 
-    int padding = (4 - (img->width * 3) % 4) % 4;
-    for (int i = img->height - 1; i >= 0; i--) {
-        for (int j = 0; j < img->width; j++) {
-            fread(&img->data[i][j].blue, 1, 1, file);
-            fread(&img->data[i][j].green, 1, 1, file);
-            fread(&img->data[i][j].red, 1, 1, file);
+    t_bmp24 *img = bmp24_allocate(roi.width, roi.height, 24);
+    unsigned char *buffer = (unsigned char *)malloc((size_t)roi.width * 3);
+    if (!img || !buffer) {
+        printf("Erreur : Allocation memoire echouee\n");
+        bmp24_free(img);
+        free(buffer);
+        fclose(file);
+        PROFILE_END(bmp24_loadImageRoi, 0);
+        return NULL;
+    }
+
+    // Une lecture par ligne de la région, où qu'elle soit dans le fichier
+    for (int i = 0; i < roi.height; i++) {
+        long position = bmpheader_rowOffset(&format, roi.y + i) + (long)roi.x * 3;
+        if (fseek(file, position, SEEK_SET) != 0 || fread(buffer, 3, roi.width, file) != (size_t)roi.width) {
+            printf("Erreur : donnees incompletes dans %s\n", filename);
+            bmp24_free(img);
+            free(buffer);
+            fclose(file);
+            PROFILE_END(bmp24_loadImageRoi, 0);
+            return NULL;
+        }
+        for (int j = 0; j < roi.width; j++) {
+            img->data[i][j].blue = buffer[j * 3];
+            img->data[i][j].green = buffer[j * 3 + 1];
+            img->data[i][j].red = buffer[j * 3 + 2];
         }
-        fseek(file, padding, SEEK_CUR);
     }
 
+    free(buffer);
     fclose(file);
+    PROFILE_BYTES_READ(sizeof(t_bmp_header) + sizeof(t_bmp_info) + (size_t)roi.width * 3 * roi.height);
+    PROFILE_END(bmp24_loadImageRoi, (size_t)roi.width * roi.height);
     return img;
 }
 
@@ -124,30 +294,113 @@ t_bmp24 *bmp24_loadImage(const char *filename) {
  * Sauvegarde une image BMP 24 bits dans un fichier
  * @param img Image à sauvegarder
  * @param filename Chemin du fichier de destination
+ * @return 0 si le fichier est entièrement écrit, -1 sinon
  */
-void bmp24_saveImage(t_bmp24 *img, const char *filename) {
+int bmp24_saveImage(t_bmp24 *img, const char *filename) {
+    PROFILE_BEGIN(bmp24_saveImage);
     FILE *file = fopen(filename, "wb");
     if (!file) {
         printf("Erreur : impossible d'écrire dans %s\n", filename);
-        return;
+        PROFILE_END(bmp24_saveImage, 0);
+        return -1;
     }
 
-    fwrite(&img->header, sizeof(t_bmp_header), 1, file);
-    fwrite(&img->header_info, sizeof(t_bmp_info), 1, file);
+    int ok = fwrite(&img->header, sizeof(t_bmp_header), 1, file) == 1 &&
+             fwrite(&img->header_info, sizeof(t_bmp_info), 1, file) == 1;
 
+    // Une écriture par ligne ; hauteur négative dans l'en-tête : lignes de haut en bas
     int padding = (4 - (img->width * 3) % 4) % 4;
-    unsigned char pad[3] = {0, 0, 0};
-
-    for (int i = img->height - 1; i >= 0; i--) {
+    int topDown = img->header_info.height < 0;
+    unsigned char *buffer = (unsigned char *)calloc((size_t)img->width * 3 + padding, 1);
+    if (!buffer) {
+        printf("Erreur : Allocation memoire echouee\n");
+        fclose(file);
+        PROFILE_END(bmp24_saveImage, 0);
+        return -1;
+    }
+    for (int r = 0; ok && r < img->height; r++) {
+        const t_pixel *row = img->data[topDown ? r : img->height - 1 - r];
         for (int j = 0; j < img->width; j++) {
-            fwrite(&img->data[i][j].blue, 1, 1, file);
-            fwrite(&img->data[i][j].green, 1, 1, file);
-            fwrite(&img->data[i][j].red, 1, 1, file);
+            buffer[j * 3] = row[j].blue;
+            buffer[j * 3 + 1] = row[j].green;
+            buffer[j * 3 + 2] = row[j].red;
         }
-        fwrite(pad, 1, padding, file);
+        ok = fwrite(buffer, 1, (size_t)img->width * 3 + padding, file) == (size_t)img->width * 3 + padding;
     }
 
-    fclose(file);
+    free(buffer);
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) {
+        printf("Erreur : Ecriture incomplete du fichier %s\n", filename);
+        PROFILE_END(bmp24_saveImage, 0);
+        return -1;
+    }
+    PROFILE_BYTES_WRITTEN(sizeof(t_bmp_header) + sizeof(t_bmp_info) + (img->width * 3 + padding) * img->height);
+    PROFILE_END(bmp24_saveImage, img->width * img->height);
+    return 0;
+}
+
+/**
+ * Construit une vue sur une région : les lignes de la vue pointent dans
+ * celles de img, tout traitement appliqué à la vue modifie donc l'image
+ * sans copie. La vue se libère avec free(view->data).
+ * @param img Image source
+ * @param roi Région (restreinte à l'image)
+ * @param view Vue à remplir
+ * @return 0 si succès, -1 si la région est vide ou en cas d'échec d'allocation
+ */
+static int bmp24_roiView(t_bmp24 *img, t_roi roi, t_bmp24 *view) {
+    if (!img || !img->data || roi_clip(&roi, img->width, img->height) != 0) return -1;
+    t_pixel **rows = (t_pixel **)malloc(roi.height * sizeof(t_pixel *));
+    if (!rows) {
+        printf("Erreur : Allocation memoire echouee\n");
+        return -1;
+    }
+    for (int i = 0; i < roi.height; i++) {
+        rows[i] = img->data[roi.y + i] + roi.x;
+    }
+    *view = *img;
+    view->width = roi.width;
+    view->height = roi.height;
+    view->data = rows;
+    return 0;
+}
+
+/**
+ * Applique un filtre négatif à une région de l'image
+ * @param img Image à modifier
+ * @param roi Région à modifier (coordonnées de haut en bas)
+ */
+void bmp24_negativeRoi(t_bmp24 *img, t_roi roi) {
+    t_bmp24 view;
+    if (bmp24_roiView(img, roi, &view) != 0) return;
+    bmp24_negative(&view);
+    free(view.data);
+}
+
+/**
+ * Convertit une région de l'image en niveaux de gris
+ * @param img Image à modifier
+ * @param roi Région à modifier (coordonnées de haut en bas)
+ */
+void bmp24_grayscaleRoi(t_bmp24 *img, t_roi roi) {
+    t_bmp24 view;
+    if (bmp24_roiView(img, roi, &view) != 0) return;
+    bmp24_grayscale(&view);
+    free(view.data);
+}
+
+/**
+ * Ajuste la luminosité d'une région de l'image
+ * @param img Image à modifier
+ * @param roi Région à modifier (coordonnées de haut en bas)
+ * @param value Valeur d'ajustement (peut être négative)
+ */
+void bmp24_brightnessRoi(t_bmp24 *img, t_roi roi, int value) {
+    t_bmp24 view;
+    if (bmp24_roiView(img, roi, &view) != 0) return;
+    bmp24_brightness(&view, value);
+    free(view.data);
 }
 
 /**
@@ -155,6 +408,7 @@ void bmp24_saveImage(t_bmp24 *img, const char *filename) {
  * @param img Image à modifier
  */
 void bmp24_negative(t_bmp24 *img) {
+    PROFILE_BEGIN(bmp24_negative);
     for (int i = 0; i < img->height; i++) {
         for (int j = 0; j < img->width; j++) {
             img->data[i][j].red = 255 - img->data[i][j].red;
@@ -162,6 +416,7 @@ void bmp24_negative(t_bmp24 *img) {
             img->data[i][j].blue = 255 - img->data[i][j].blue;
         }
     }
+    PROFILE_END(bmp24_negative, img->width * img->height);
 }
 
 /**
@@ -169,6 +424,7 @@ void bmp24_negative(t_bmp24 *img) {
  * @param img Image à convertir
  */
 void bmp24_grayscale(t_bmp24 *img) {
+    PROFILE_BEGIN(bmp24_grayscale);
     for (int i = 0; i < img->height; i++) {
         for (int j = 0; j < img->width; j++) {
             uint8_t r = img->data[i][j].red;
@@ -181,6 +437,104 @@ void bmp24_grayscale(t_bmp24 *img) {
             img->data[i][j].blue = gray;
         }
     }
+    PROFILE_END(bmp24_grayscale, img->width * img->height);
+}
+
+// Contexte des conversions 24 <-> 8 bits, par bandes de lignes
+typedef struct {
+    t_bmp24 *img24;
+    t_bmp8 *img8;
+    int weightR;
+    int weightG;
+    int weightB;
+} t_convertJob;
+
+/**
+ * Calcule la luminance des lignes [begin, end) (lignes du haut vers le bas ;
+ * les lignes d'un t_bmp8 sont stockées dans l'ordre du fichier, de bas en haut)
+ */
+static void bmp24_toGray8Rows(void *ctx, int begin, int end) {
+    t_convertJob *job = (t_convertJob *)ctx;
+    int width = job->img24->width;
+    int wr = job->weightR, wg = job->weightG, wb = job->weightB;
+    for (int y = begin; y < end; y++) {
+        const t_pixel *src = job->img24->data[y];
+        unsigned char *dst = job->img8->data + (size_t)(job->img24->height - 1 - y) * width;
+        for (int x = 0; x < width; x++) {
+            dst[x] = (unsigned char)((wr * src[x].red + wg * src[x].green + wb * src[x].blue + 128) >> 8);
+        }
+    }
+}
+
+/**
+ * Convertit l'image en une vraie image 8 bits en niveaux de gris, en une
+ * passe et en arithmétique entière (poids sur 256)
+ * @param img Image source (inchangée)
+ * @param standard GRAY_BT601 (0,299 / 0,587 / 0,114) ou GRAY_BT709 (0,2126 / 0,7152 / 0,0722)
+ * @return Nouvelle image 8 bits avec palette de gris, NULL en cas d'échec
+ */
+t_bmp8 *bmp24_toGray8(t_bmp24 *img, t_grayStandard standard) {
+    if (!img || !img->data) return NULL;
+    PROFILE_BEGIN(bmp24_toGray8);
+
+    t_bmp8 *gray = bmp8_allocate(img->width, img->height);
+    if (!gray) {
+        PROFILE_END(bmp24_toGray8, 0);
+        return NULL;
+    }
+
+    t_convertJob job = {img, gray, 77, 150, 29};
+    if (standard == GRAY_BT709) {
+        job.weightR = 54;
+        job.weightG = 183;
+        job.weightB = 19;
+    }
+    threadpool_parallelFor(0, img->height, 0, bmp24_toGray8Rows, &job);
+
+    PROFILE_END(bmp24_toGray8, img->width * img->height);
+    return gray;
+}
+
+/**
+ * Développe les lignes [begin, end) d'une image 8 bits à travers sa palette
+ */
+static void bmp24_fromBmp8Rows(void *ctx, int begin, int end) {
+    t_convertJob *job = (t_convertJob *)ctx;
+    int width = job->img24->width;
+    const unsigned char *palette = job->img8->colorTable;
+    for (int y = begin; y < end; y++) {
+        const unsigned char *src = job->img8->data + (size_t)(job->img24->height - 1 - y) * width;
+        t_pixel *dst = job->img24->data[y];
+        for (int x = 0; x < width; x++) {
+            const unsigned char *entry = &palette[src[x] * 4]; // B, G, R, réservé
+            dst[x].blue = entry[0];
+            dst[x].green = entry[1];
+            dst[x].red = entry[2];
+        }
+    }
+}
+
+/**
+ * Convertit une image 8 bits (à palette) en image 24 bits
+ * @param img Image 8 bits source (inchangée)
+ * @return Nouvelle image 24 bits, NULL en cas d'échec
+ */
+t_bmp24 *bmp24_fromBmp8(t_bmp8 *img) {
+    if (!img || !img->data) return NULL;
+    PROFILE_BEGIN(bmp24_fromBmp8);
+
+    t_bmp24 *color = bmp24_allocate(img->width, img->height, 24);
+    if (!color) {
+        printf("Erreur : Allocation memoire echouee pour la conversion.\n");
+        PROFILE_END(bmp24_fromBmp8, 0);
+        return NULL;
+    }
+
+    t_convertJob job = {color, img, 0, 0, 0};
+    threadpool_parallelFor(0, color->height, 0, bmp24_fromBmp8Rows, &job);
+
+    PROFILE_END(bmp24_fromBmp8, img->dataSize);
+    return color;
 }
 
 /**
@@ -189,6 +543,7 @@ void bmp24_grayscale(t_bmp24 *img) {
  * @param value Valeur d'ajustement (peut être négative)
  */
 void bmp24_brightness(t_bmp24 *img, int value) {
+    PROFILE_BEGIN(bmp24_brightness);
     for (int i = 0; i < img->height; i++) {
         for (int j = 0; j < img->width; j++) {
             int r = img->data[i][j].red + value;
@@ -200,8 +555,15 @@ void bmp24_brightness(t_bmp24 *img, int value) {
             img->data[i][j].blue = (b > 255) ? 255 : (b < 0 ? 0 : b);
         }
     }
+    PROFILE_END(bmp24_brightness, img->width * img->height);
 }
 
+// Contexte partagé par les tâches parallèles sur des bandes de lignes
+typedef struct {
+    t_bmp24 *img;
+    unsigned char *luma;
+} t_rowJob24;
+
 /**
  * Effectue une convolution sur un pixel de l'image
  * @param img Image source
@@ -237,27 +599,189 @@ t_pixel bmp24_convolution(t_bmp24 *img, int x, int y, float **kernel, int kernel
     return result;
 }
 
+/**
+ * Convolution par FFT, canal par canal (noyaux de grande taille)
+ * @param img Image à modifier
+ * @param kernel Noyau de convolution
+ * @param kernelSize Taille du noyau
+ * @return 0 si succès, -1 en cas d'échec (image inchangée)
+ */
+static int bmp24_applyFilterFFT(t_bmp24 *img, float **kernel, int kernelSize) {
+    // Les trois canaux sont convolués avant d'être recopiés : un échec
+    // sur l'un d'eux laisse l'image intacte pour le chemin direct
+    size_t size = (size_t)img->width * img->height;
+    unsigned char *planes = (unsigned char *)malloc(3 * size);
+    if (!planes) return -1;
+    PROFILE_ALLOC(3 * size);
+
+    for (int y = 0; y < img->height; y++) {
+        for (int x = 0; x < img->width; x++) {
+            t_pixel p = img->data[y][x];
+            size_t i = (size_t)y * img->width + x;
+            planes[i] = p.red;
+            planes[size + i] = p.green;
+            planes[2 * size + i] = p.blue;
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        if (fft_convolvePlane(planes + c * size, img->width, img->height, kernel, kernelSize) != 0) {
+            free(planes);
+            return -1;
+        }
+    }
+    for (int y = 0; y < img->height; y++) {
+        for (int x = 0; x < img->width; x++) {
+            size_t i = (size_t)y * img->width + x;
+            img->data[y][x].red = planes[i];
+            img->data[y][x].green = planes[size + i];
+            img->data[y][x].blue = planes[2 * size + i];
+        }
+    }
+
+    free(planes);
+    return 0;
+}
+
+// Contexte du filtrage sur place, par bandes de lignes internes. Chaque
+// bande garde dans un anneau de kernelSize lignes les valeurs d'origine
+// qu'elle s'apprête à écraser ; les lignes voisines des autres bandes
+// (halo) sont copiées avant la passe, puisqu'elles peuvent déjà avoir été
+// réécrites quand la bande les lit.
+typedef struct {
+    t_bmp24 *img;
+    float **kernel;
+    int kernelSize;
+    int first;          // première ligne interne
+    int last;           // dernière ligne interne (exclue)
+    int bandRows;
+    t_pixel *halo;      // par bande : offset lignes au-dessus puis offset lignes en dessous
+    t_pixel *rings;     // par bande : kernelSize lignes
+} t_filterJob24;
+
+// Ligne d'origine y, vue depuis la bande [begin, end)
+static const t_pixel *bmp24_sourceRow(const t_filterJob24 *job, int band, int begin, int end, int y) {
+    int offset = job->kernelSize / 2;
+    size_t width = job->img->width;
+    t_pixel *halo = job->halo + (size_t)band * 2 * offset * width;
+    if (y < begin) return halo + (size_t)(y - (begin - offset)) * width;
+    if (y >= end) return halo + (size_t)(offset + y - end) * width;
+    return job->img->data[y];
+}
+
+static void bmp24_filterBands(void *ctx, int beginBand, int endBand) {
+    t_filterJob24 *job = (t_filterJob24 *)ctx;
+    int k = job->kernelSize;
+    int offset = k / 2;
+    int width = job->img->width;
+
+    for (int band = beginBand; band < endBand; band++) {
+        int begin = job->first + band * job->bandRows;
+        int end = (begin + job->bandRows < job->last) ? begin + job->bandRows : job->last;
+        t_pixel *ring = job->rings + (size_t)band * k * width;
+
+        // Anneau : la ligne r est rangée à l'emplacement r % k
+        for (int r = begin - offset; r < begin + offset; r++) {
+            memcpy(ring + (size_t)(r % k) * width, bmp24_sourceRow(job, band, begin, end, r), width * sizeof(t_pixel));
+        }
+        for (int y = begin; y < end; y++) {
+            int below = y + offset;
+            memcpy(ring + (size_t)(below % k) * width, bmp24_sourceRow(job, band, begin, end, below), width * sizeof(t_pixel));
+
+            t_pixel *out = job->img->data[y];
+            for (int x = offset; x < width - offset; x++) {
+                float r = 0.0f, g = 0.0f, b = 0.0f;
+                for (int ky = -offset; ky <= offset; ky++) {
+                    const t_pixel *row = ring + (size_t)((y + ky) % k) * width;
+                    for (int kx = -offset; kx <= offset; kx++) {
+                        t_pixel p = row[x + kx];
+                        float coeff = job->kernel[ky + offset][kx + offset];
+                        r += p.red * coeff;
+                        g += p.green * coeff;
+                        b += p.blue * coeff;
+                    }
+                }
+                out[x].red = (uint8_t)fminf(fmaxf(roundf(r), 0), 255);
+                out[x].green = (uint8_t)fminf(fmaxf(roundf(g), 0), 255);
+                out[x].blue = (uint8_t)fminf(fmaxf(roundf(b), 0), 255);
+            }
+        }
+    }
+}
+
 /**
  * Applique un filtre générique à l'image à partir d'un noyau de convolution
+ * (par FFT au-delà de FFT_CROSSOVER_KERNEL_SIZE, à ±1 niveau près). Le
+ * calcul se fait sur place : les lignes de l'image ne sont jamais
+ * réallouées (elles peuvent appartenir à une mémoire partagée) et les
+ * bords restent inchangés.
  * @param img Image à modifier
  * @param kernel Noyau de convolution
  * @param kernelSize Taille du noyau
  */
 void bmp24_applyFilter(t_bmp24 *img, float **kernel, int kernelSize) {
-    t_pixel **newData = bmp24_allocateDataPixels(img->width, img->height);
-    if (!newData) return;
-
+    if (!img || !kernel) return;
     int offset = kernelSize / 2;
+    if (img->width <= 2 * offset || img->height <= 2 * offset) return;
 
-    for (int y = offset; y < img->height - offset; y++) {
-        for (int x = offset; x < img->width - offset; x++) {
-            newData[y][x] = bmp24_convolution(img, x, y, kernel, kernelSize);
+    PROFILE_BEGIN(bmp24_applyFilter);
+    if (kernelSize >= FFT_CROSSOVER_KERNEL_SIZE && bmp24_applyFilterFFT(img, kernel, kernelSize) == 0) {
+        PROFILE_END(bmp24_applyFilter, img->width * img->height);
+        return;
+    }
+
+    // Découpage en bandes d'au moins kernelSize lignes
+    t_filterJob24 job = {img, kernel, kernelSize, offset, img->height - offset, 0, NULL, NULL};
+    int rows = job.last - job.first;
+    job.bandRows = rows / (4 * threadpool_threadCount());
+    if (job.bandRows < kernelSize) job.bandRows = kernelSize;
+    int bands = (rows + job.bandRows - 1) / job.bandRows;
+
+    size_t rowBytes = img->width * sizeof(t_pixel);
+    job.halo = (t_pixel *)malloc((size_t)bands * 2 * offset * rowBytes);
+    job.rings = (t_pixel *)malloc((size_t)bands * kernelSize * rowBytes);
+    if (!job.halo || !job.rings) {
+        printf("Erreur : Allocation memoire echouee pour le filtrage.\n");
+        free(job.halo);
+        free(job.rings);
+        PROFILE_END(bmp24_applyFilter, 0);
+        return;
+    }
+    PROFILE_ALLOC((size_t)bands * (2 * offset + kernelSize) * rowBytes);
+
+    for (int band = 0; band < bands; band++) {
+        int begin = job.first + band * job.bandRows;
+        int end = (begin + job.bandRows < job.last) ? begin + job.bandRows : job.last;
+        t_pixel *halo = job.halo + (size_t)band * 2 * offset * img->width;
+        for (int i = 0; i < offset; i++) {
+            memcpy(halo + (size_t)i * img->width, img->data[begin - offset + i], rowBytes);
+            memcpy(halo + (size_t)(offset + i) * img->width, img->data[end + i], rowBytes);
         }
     }
+    threadpool_parallelFor(0, bands, 1, bmp24_filterBands, &job);
 
-    // Remplacer l'ancienne data
-    bmp24_freeDataPixels(img->data, img->height);
-    img->data = newData;
+    free(job.halo);
+    free(job.rings);
+    PROFILE_END(bmp24_applyFilter, img->width * img->height);
+}
+
+/**
+ * Filtre une région de l'image. La vue filtrée couvre la région et son
+ * voisinage (kernelSize / 2 pixels) : bmp24_applyFilter ne recalcule que
+ * l'intérieur de la vue, c'est-à-dire exactement la région, en lisant le
+ * voisinage sans le modifier. Le résultat est celui du filtrage de toute
+ * l'image restreint à la région.
+ * @param img Image à modifier
+ * @param roi Région à filtrer (coordonnées de haut en bas)
+ * @param kernel Noyau de convolution
+ * @param kernelSize Taille du noyau
+ */
+void bmp24_applyFilterRoi(t_bmp24 *img, t_roi roi, float **kernel, int kernelSize) {
+    if (!img || !kernel) return;
+    t_bmp24 view;
+    t_roi window = roi_expand(roi, kernelSize / 2, img->width, img->height);
+    if (bmp24_roiView(img, window, &view) != 0) return;
+    bmp24_applyFilter(&view, kernel, kernelSize);
+    free(view.data);
 }
 
 /**
@@ -339,6 +863,67 @@ void bmp24_sharpen(t_bmp24 *img) {
     free(kernel);
 }
 
+static void bmp24_extractLumaRows(void *ctx, int begin, int end) {
+    t_rowJob24 *job = (t_rowJob24 *)ctx;
+    int width = job->img->width;
+
+    // Convert RGB to Y (luminance)
+    for (int y = begin; y < end; y++) {
+        for (int x = 0; x < width; x++) {
+            t_pixel p = job->img->data[y][x];
+            job->luma[y * width + x] = (unsigned char)(0.299f * p.red + 0.587f * p.green + 0.114f * p.blue);
+        }
+    }
+}
+
+/**
+ * Extrait la luminance (Y) de l'image, tronquée sur un octet
+ * @param img Image source
+ * @return Plan de luminance width * height alloué, NULL en cas d'échec
+ */
+static unsigned char *bmp24_extractLuma(t_bmp24 *img) {
+    unsigned char *Y = (unsigned char *)malloc(img->width * img->height);
+    if (!Y) return NULL;
+    PROFILE_ALLOC(img->width * img->height);
+
+    t_rowJob24 job = {img, Y};
+    threadpool_parallelFor(0, img->height, 0, bmp24_extractLumaRows, &job);
+    return Y;
+}
+
+static void bmp24_applyLumaRows(void *ctx, int begin, int end) {
+    t_rowJob24 *job = (t_rowJob24 *)ctx;
+    int width = job->img->width;
+    for (int y = begin; y < end; y++) {
+        for (int x = 0; x < width; x++) {
+            float newY = job->luma[y * width + x];
+            t_pixel *p = &job->img->data[y][x];
+
+            // Conversion YUV vers RGB
+            float U = -0.14713f * p->red - 0.28886f * p->green + 0.436f * p->blue;
+            float V = 0.615f * p->red - 0.51499f * p->green - 0.10001f * p->blue;
+
+            int r = roundf(newY + 1.13983f * V);
+            int g = roundf(newY - 0.39465f * U - 0.58060f * V);
+            int b = roundf(newY + 2.03211f * U);
+
+            p->red = (r > 255) ? 255 : (r < 0 ? 0 : r);
+            p->green = (g > 255) ? 255 : (g < 0 ? 0 : g);
+            p->blue = (b > 255) ? 255 : (b < 0 ? 0 : b);
+        }
+    }
+}
+
+/**
+ * Remplace la luminance de chaque pixel en conservant sa chrominance (U, V)
+ * @param img Image à modifier
+ * @param newLuma Nouvelle luminance, width * height octets
+ */
+static void bmp24_applyLuma(t_bmp24 *img, const unsigned char *newLuma) {
+    t_rowJob24 job = {img, (unsigned char *)newLuma};
+    threadpool_parallelFor(0, img->height, 0, bmp24_applyLumaRows, &job);
+}
+
 /**
  * Égalise l'histogramme de l'image pour améliorer le contraste
  * @param img Image à modifier
@@ -348,19 +933,15 @@ void bmp24_equalizeHistogram(t_bmp24 *img) {
 
     int width = img->width;
     int height = img->height;
-    int histogram[256] = {0};
+    int histogram[256];
 
-    float *Y = (float *)malloc(width * height * sizeof(float));
-
-    // Convert RGB to Y (luminance)
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            t_pixel p = img->data[y][x];
-            int index = y * width + x;
-            Y[index] = 0.299f * p.red + 0.587f * p.green + 0.114f * p.blue;
-            histogram[(int)Y[index]]++;
-        }
+    PROFILE_BEGIN(bmp24_equalizeHistogram);
+    unsigned char *Y = bmp24_extractLuma(img);
+    if (!Y) {
+        PROFILE_END(bmp24_equalizeHistogram, 0);
+        return;
     }
+    histogram_compute(Y, (size_t)width * height, histogram);
 
     // Calcul du CDF (Cumulative Distribution Function)
     float cdf[256] = {0};
@@ -385,25 +966,89 @@ void bmp24_equalizeHistogram(t_bmp24 *img) {
     }
 
     // Application de l'égalisation
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int index = y * width + x;
-            float newY = equalized[(int)Y[index]];
-            t_pixel *p = &img->data[y][x];
+    histogram_applyLut(Y, (size_t)width * height, equalized);
+    bmp24_applyLuma(img, Y);
 
-            // Conversion YUV vers RGB
-            float U = -0.14713f * p->red - 0.28886f * p->green + 0.436f * p->blue;
-            float V = 0.615f * p->red - 0.51499f * p->green - 0.10001f * p->blue;
+    free(Y);
+    PROFILE_END(bmp24_equalizeHistogram, width * height);
+}
 
-            int r = roundf(newY + 1.13983f * V);
-            int g = roundf(newY - 0.39465f * U - 0.58060f * V);
-            int b = roundf(newY + 2.03211f * U);
+/**
+ * Égalise l'histogramme d'une région avec son propre histogramme de
+ * luminance, sans lire ni modifier le reste de l'image
+ * @param img Image à modifier
+ * @param roi Région à égaliser (coordonnées de haut en bas)
+ */
+void bmp24_equalizeHistogramRoi(t_bmp24 *img, t_roi roi) {
+    t_bmp24 view;
+    if (bmp24_roiView(img, roi, &view) != 0) return;
+    bmp24_equalizeHistogram(&view);
+    free(view.data);
+}
 
-            p->red = (r > 255) ? 255 : (r < 0 ? 0 : r);
-            p->green = (g > 255) ? 255 : (g < 0 ? 0 : g);
-            p->blue = (b > 255) ? 255 : (b < 0 ? 0 : b);
-        }
-    }
+/**
+ * Égalisation adaptative (CLAHE) sur la luminance de l'image :
+ * même chemin luma que bmp24_equalizeHistogram, mais avec des
+ * histogrammes par tuile écrêtés et interpolés
+ * @param img Image à modifier
+ * @param tilesX Nombre de tuiles horizontales
+ * @param tilesY Nombre de tuiles verticales
+ * @param clipLimit Limite d'écrêtage (multiple de la moyenne par niveau)
+ */
+void bmp24_clahe(t_bmp24 *img, int tilesX, int tilesY, float clipLimit) {
+    if (!img || !img->data) return;
 
+    PROFILE_BEGIN(bmp24_clahe);
+    unsigned char *Y = bmp24_extractLuma(img);
+    if (!Y) {
+        PROFILE_END(bmp24_clahe, 0);
+        return;
+    }
+    histogram_clahe(Y, img->width, img->height, tilesX, tilesY, clipLimit);
+    bmp24_applyLuma(img, Y);
     free(Y);
-}
\ No newline at end of file
+    PROFILE_END(bmp24_clahe, img->width * img->height);
+}
+
+// Contexte d'un traitement par lot
+typedef struct {
+    const char **inputs;
+    const char **outputs;
+    void (*process)(t_bmp24 *img);
+    int *succeeded;
+} t_batchJob24;
+
+static void bmp24_batchTask(void *ctx, int begin, int end) {
+    t_batchJob24 *job = (t_batchJob24 *)ctx;
+    for (int i = begin; i < end; i++) {
+        t_bmp24 *img = bmp24_loadImage(job->inputs[i]);
+        if (!img) continue;
+        job->process(img);
+        job->succeeded[i] = bmp24_saveImage(img, job->outputs[i]) == 0;
+        bmp24_free(img);
+    }
+}
+
+/**
+ * Traite un lot d'images en parallèle (une tâche par image). Les
+ * traitements internes parallèles partagent le même pool, sans créer
+ * de threads supplémentaires.
+ * @param inputs Chemins des images à charger
+ * @param outputs Chemins des images à écrire
+ * @param count Nombre d'images
+ * @param process Traitement appliqué à chaque image
+ * @return Nombre d'images traitées avec succès
+ */
+int bmp24_processBatch(const char **inputs, const char **outputs, int count, void (*process)(t_bmp24 *img)) {
+    if (!inputs || !outputs || !process || count <= 0) return 0;
+    int *succeeded = (int *)calloc(count, sizeof(int));
+    if (!succeeded) return 0;
+
+    t_batchJob24 job = {inputs, outputs, process, succeeded};
+    threadpool_parallelFor(0, count, 1, bmp24_batchTask, &job);
+
+    int total = 0;
+    for (int i = 0; i < count; i++) total += succeeded[i];
+    free(succeeded);
+    return total;
+}
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "bmp8.h"
+#include "roi.h"
 
 #pragma pack(push, 1)  // Désactive l’alignement mémoire
 
@@ -46,21 +48,35 @@ typedef struct {
     t_pixel **data;
 } t_bmp24;
 
+// Coefficients de luminance pour la conversion en 8 bits
+typedef enum {
+    GRAY_BT601,
+    GRAY_BT709
+} t_grayStandard;
+
 // Fonctions à implémenter
 t_pixel **bmp24_allocateDataPixels(int width, int height);
 void bmp24_freeDataPixels(t_pixel **pixels, int height);
 
 t_bmp24 *bmp24_allocate(int width, int height, int colorDepth);
+void bmp24_initHeaders(t_bmp24 *img);
+t_bmp24 *bmp24_copy(const t_bmp24 *img);
 void bmp24_free(t_bmp24 *img);
 
 t_bmp24 *bmp24_loadImage(const char *filename);
-void bmp24_saveImage(t_bmp24 *img, const char *filename);
+t_bmp24 *bmp24_loadImageReuse(const char *filename, t_bmp24 *spare);
+t_bmp24 *bmp24_loadImageRoi(const char *filename, t_roi roi);
+int bmp24_saveImage(t_bmp24 *img, const char *filename);
 
 void bmp24_negative(t_bmp24 *img);
 void bmp24_grayscale(t_bmp24 *img);
 void bmp24_brightness(t_bmp24 *img, int value);
 
+t_bmp8 *bmp24_toGray8(t_bmp24 *img, t_grayStandard standard);
+t_bmp24 *bmp24_fromBmp8(t_bmp8 *img);
+
 t_pixel bmp24_convolution(t_bmp24 *img, int x, int y, float **kernel, int kernelSize);
+void bmp24_applyFilter(t_bmp24 *img, float **kernel, int kernelSize);
 
 void bmp24_boxBlur(t_bmp24 *img);
 void bmp24_gaussianBlur(t_bmp24 *img);
@@ -69,6 +85,16 @@ void bmp24_emboss(t_bmp24 *img);
 void bmp24_sharpen(t_bmp24 *img);
 
 void bmp24_equalizeHistogram(t_bmp24 *img);
+void bmp24_clahe(t_bmp24 *img, int tilesX, int tilesY, float clipLimit);
+
+// Variantes limitées à une région (coordonnées de haut en bas, voir roi.h)
+void bmp24_negativeRoi(t_bmp24 *img, t_roi roi);
+void bmp24_grayscaleRoi(t_bmp24 *img, t_roi roi);
+void bmp24_brightnessRoi(t_bmp24 *img, t_roi roi, int value);
+void bmp24_applyFilterRoi(t_bmp24 *img, t_roi roi, float **kernel, int kernelSize);
+void bmp24_equalizeHistogramRoi(t_bmp24 *img, t_roi roi);
+
+int bmp24_processBatch(const char **inputs, const char **outputs, int count, void (*process)(t_bmp24 *img));
 
 
 #pragma pack(pop)  // Rétablit l’alignement par défaut
@@ -1,8 +1,71 @@
 #include "bmp8.h"
+#include "bmpheader.h"
+#include "histogram.h"
+#include "fft.h"
+#include "profile.h"
+#include "threadpool.h"
 #include <math.h>   // pour round()
 #include <stdlib.h>
+#include <string.h> // pour memset
 #include <dirent.h> // pour la gestion de répertoires si besoin
 
+// Taille d'une ligne dans le fichier (les lignes BMP sont alignées sur 4 octets)
+static unsigned int bmp8_rowStride(unsigned int width) {
+    return (width + 3) & ~3u;
+}
+
+// Écriture d'un entier little-endian dans l'en-tête
+static void bmp8_setHeaderField(unsigned char *header, int offset, unsigned int value, int size) {
+    for (int i = 0; i < size; i++) {
+        header[offset + i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+// Lecture d'un entier little-endian dans l'en-tête
+static unsigned int bmp8_getHeaderField(const unsigned char *header, int offset, int size) {
+    unsigned int value = 0;
+    for (int i = 0; i < size; i++) {
+        value |= (unsigned int)header[offset + i] << (8 * i);
+    }
+    return value;
+}
+
+// Première ligne de stockage (les lignes sont rangées de bas en haut) d'une
+// région exprimée de haut en bas
+static unsigned int bmp8_roiFirstRow(unsigned int height, t_roi roi) {
+    return height - roi.y - roi.height;
+}
+
+#ifdef PROJETC_PROFILING
+// Nombre de pixels d'une région une fois restreinte à l'image (compteurs
+// de profilage uniquement)
+static size_t bmp8_roiArea(const t_bmp8 *img, t_roi roi) {
+    if (roi_clip(&roi, img->width, img->height) != 0) return 0;
+    return (size_t)roi.width * roi.height;
+}
+#endif
+
+// Lecture de la palette (colors entrées juste après l'en-tête d'information),
+// complétée par des zéros
+static int bmp8_readPalette(FILE *file, const t_bmpFormat *format, unsigned char *colorTable) {
+    memset(colorTable, 0, 1024);
+    return (fseek(file, BMP_FILE_HEADER_SIZE + (long)format->infoSize, SEEK_SET) == 0 &&
+            fread(colorTable, 4, format->colors, file) == format->colors) ? 0 : -1;
+}
+
+// Ramène l'en-tête chargé à la forme écrite par bmp8_saveImage : en-tête
+// d'information de 40 octets suivi de la palette complète. Le signe de la
+// hauteur est conservé pour réécrire les lignes dans l'ordre du fichier.
+static void bmp8_normalizeHeader(t_bmp8 *img) {
+    unsigned int imageSize = bmp8_rowStride(img->width) * img->height;
+    bmp8_setHeaderField(img->header, 2, 54 + 1024 + imageSize, 4);
+    bmp8_setHeaderField(img->header, 10, 54 + 1024, 4);
+    bmp8_setHeaderField(img->header, 14, 40, 4);
+    bmp8_setHeaderField(img->header, 34, imageSize, 4);
+    bmp8_setHeaderField(img->header, 46, 256, 4);
+    bmp8_setHeaderField(img->header, 50, 0, 4);
+}
+
 // === Fonction : bmp8_loadImage ===
 // Paramètres :
 //    - filename : chemin vers le fichier image BMP 8 bits à charger
@@ -11,55 +74,173 @@
 // Sortie :
 //    - Retourne un pointeur vers la structure t_bmp8 si succès, sinon NULL
 t_bmp8 *bmp8_loadImage(const char *filename) {
+    return bmp8_loadImageReuse(filename, NULL);
+}
+
+// === Fonction : bmp8_loadImageReuse ===
+// Paramètres :
+//    - filename : chemin vers le fichier image BMP 8 bits à charger
+//    - spare : image déjà allouée à recycler (peut être NULL), prise en
+//      charge dans tous les cas
+// But :
+//    - Charger une image en réutilisant le tampon de pixels de spare quand
+//      la taille correspond (évite une allocation par image dans les
+//      traitements en série)
+// Sortie :
+//    - Retourne un pointeur vers la structure t_bmp8 si succès, sinon NULL
+t_bmp8 *bmp8_loadImageReuse(const char *filename, t_bmp8 *spare) {
+    PROFILE_BEGIN(bmp8_loadImage);
     FILE *file = fopen(filename, "rb");
     if (!file) {
         printf("Erreur : Impossible d'ouvrir le fichier %s\n", filename);
+        bmp8_free(spare);
+        PROFILE_END(bmp8_loadImage, 0);
         return NULL;
     }
 
-    t_bmp8 *img = (t_bmp8 *)malloc(sizeof(t_bmp8));
-    if (!img) {
-        printf("Erreur : Allocation memoire echouee\n");
+    // Validation complète de l'en-tête avant toute allocation
+    t_bmpFormat format;
+    t_bmpError error = bmpheader_read(file, &format);
+    if (error != BMP_OK || format.bits != 8) {
+        if (error != BMP_OK) printf("Erreur : Fichier BMP invalide (%s) : %s\n", bmpheader_errorMessage(error), filename);
+        else printf("Erreur : Ce programme prend uniquement les images BMP 8 bits.\n");
+        bmp8_free(spare);
         fclose(file);
+        PROFILE_END(bmp8_loadImage, 0);
         return NULL;
     }
 
-    // Lecture de l'en-tête BMP (54 octets)
-    fread(img->header, sizeof(unsigned char), 54, file);
+    t_bmp8 *img = spare;
+    unsigned char *reusable = NULL;
+    size_t reusableSize = 0;
+    if (img) {
+        reusable = img->data;
+        reusableSize = img->dataSize;
+    } else {
+        img = (t_bmp8 *)malloc(sizeof(t_bmp8));
+        if (!img) {
+            printf("Erreur : Allocation memoire echouee\n");
+            fclose(file);
+            PROFILE_END(bmp8_loadImage, 0);
+            return NULL;
+        }
+        PROFILE_ALLOC(sizeof(t_bmp8));
+    }
+    img->data = NULL;
+
+    // Métadonnées validées (hauteur positive, même pour un fichier de haut en bas)
+    memcpy(img->header, format.raw, 54);
+    img->width = format.width;
+    img->height = format.height;
+    img->colorDepth = 8;
+    img->dataSize = img->width * img->height;
+    bmp8_normalizeHeader(img);
 
-    // Récupération des métadonnées de l'image
-    img->width = *(unsigned int *)&img->header[18];
-    img->height = *(unsigned int *)&img->header[22];
-    img->colorDepth = *(unsigned short *)&img->header[28];
+    // Allocation (ou réutilisation) des données de l'image
+    if (reusable && reusableSize == img->dataSize) {
+        img->data = reusable;
+    } else {
+        free(reusable);
+        img->data = (unsigned char *)malloc(img->dataSize);
+        if (!img->data) {
+            printf("Erreur : Allocation memoire pour les donnees echouee\n");
+            free(img);
+            fclose(file);
+            PROFILE_END(bmp8_loadImage, 0);
+            return NULL;
+        }
+        PROFILE_ALLOC(img->dataSize);
+    }
 
-    // Vérification que l'image est bien en 8 bits
-    if (img->colorDepth != 8) {
-        printf("Erreur : Ce programme prend uniquement les images BMP 8 bits.\n");
-        free(img);
-        fclose(file);
+    // Palette puis pixels, dans l'ordre du fichier : les lignes d'un fichier
+    // de haut en bas sont rangées directement à leur place (de bas en haut
+    // en mémoire), sans passe de retournement
+    int ok = bmp8_readPalette(file, &format, img->colorTable) == 0 &&
+             fseek(file, format.dataOffset, SEEK_SET) == 0;
+    unsigned int padding = format.stride - img->width;
+    if (ok && !format.topDown && padding == 0) {
+        ok = fread(img->data, sizeof(unsigned char), img->dataSize, file) == img->dataSize;
+    } else {
+        unsigned char pad[3];
+        for (unsigned int r = 0; ok && r < img->height; r++) {
+            unsigned int row = img->height - 1 - bmpheader_rowAt(&format, r);
+            ok = fread(img->data + (size_t)row * img->width, sizeof(unsigned char), img->width, file) == img->width &&
+                 fread(pad, sizeof(unsigned char), padding, file) == padding;
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        printf("Erreur : Lecture des donnees impossible : %s\n", filename);
+        bmp8_free(img);
+        PROFILE_END(bmp8_loadImage, 0);
         return NULL;
     }
 
-    // Lecture de la palette de couleurs (1024 octets pour 256 couleurs)
-    fread(img->colorTable, sizeof(unsigned char), 1024, file);
+    PROFILE_BYTES_READ(format.dataOffset + format.stride * img->height);
+    PROFILE_END(bmp8_loadImage, img->dataSize);
+    return img;
+}
 
-    // Aller à l'offset des données
-    unsigned int dataOffset = *(unsigned int *)&img->header[10];
-    fseek(file, dataOffset, SEEK_SET);
+// === Fonction : bmp8_loadImageRoi ===
+// Paramètres :
+//    - filename : chemin vers le fichier image BMP 8 bits
+//    - roi : région à charger (coordonnées de haut en bas, restreinte à l'image)
+// But :
+//    - Ne lire du fichier que les lignes et colonnes couvrant la région :
+//      le coût dépend de la taille de la région et non de celle de l'image
+// Sortie :
+//    - Retourne une image de la taille de la région (palette du fichier),
+//      NULL en cas d'erreur ou si la région est hors de l'image
+t_bmp8 *bmp8_loadImageRoi(const char *filename, t_roi roi) {
+    PROFILE_BEGIN(bmp8_loadImageRoi);
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Erreur : Impossible d'ouvrir le fichier %s\n", filename);
+        PROFILE_END(bmp8_loadImageRoi, 0);
+        return NULL;
+    }
 
-    // Allocation et lecture des données de l'image
-    img->dataSize = img->width * img->height;
-    img->data = (unsigned char *)malloc(img->dataSize);
-    if (!img->data) {
-        printf("Erreur : Allocation memoire pour les donnees echouee\n");
-        free(img);
+    t_bmpFormat format;
+    t_bmpError error = bmpheader_read(file, &format);
+    if (error != BMP_OK || format.bits != 8) {
+        if (error != BMP_OK) printf("Erreur : Fichier BMP invalide (%s) : %s\n", bmpheader_errorMessage(error), filename);
+        else printf("Erreur : Ce programme prend uniquement les images BMP 8 bits.\n");
         fclose(file);
+        PROFILE_END(bmp8_loadImageRoi, 0);
+        return NULL;
+    }
+    if (roi_clip(&roi, format.width, format.height) != 0) {
+        printf("Erreur : La region est en dehors de l'image %s\n", filename);
+        fclose(file);
+        PROFILE_END(bmp8_loadImageRoi, 0);
         return NULL;
     }
 
-    fread(img->data, sizeof(unsigned char), img->dataSize, file);
+    t_bmp8 *img = bmp8_allocate(roi.width, roi.height);
+    if (!img) {
+        fclose(file);
+        PROFILE_END(bmp8_loadImageRoi, 0);
+        return NULL;
+    }
 
+    // Ligne de stockage r de la région (de bas en haut) = ligne
+    // roi.y + roi.height - 1 - r de l'image, où qu'elle soit dans le fichier
+    int ok = bmp8_readPalette(file, &format, img->colorTable) == 0;
+    for (int r = 0; ok && r < roi.height; r++) {
+        long position = bmpheader_rowOffset(&format, roi.y + roi.height - 1 - r) + roi.x;
+        ok = fseek(file, position, SEEK_SET) == 0 &&
+             fread(img->data + (size_t)r * roi.width, sizeof(unsigned char), roi.width, file) == (size_t)roi.width;
+    }
     fclose(file);
+    if (!ok) {
+        printf("Erreur : Donnees incompletes dans %s\n", filename);
+        bmp8_free(img);
+        PROFILE_END(bmp8_loadImageRoi, 0);
+        return NULL;
+    }
+
+    PROFILE_BYTES_READ(54 + 4 * format.colors + img->dataSize);
+    PROFILE_END(bmp8_loadImageRoi, img->dataSize);
     return img;
 }
 
@@ -70,19 +251,126 @@ t_bmp8 *bmp8_loadImage(const char *filename) {
 // But :
 //    - Écrire une image BMP 8 bits à partir de la structure t_bmp8
 // Sortie :
-//    - Aucun retour ; le fichier est écrit sur disque
-void bmp8_saveImage(const char *filename, t_bmp8 *img) {
+//    - Retourne 0 si le fichier est entièrement écrit, -1 sinon
+int bmp8_saveImage(const char *filename, t_bmp8 *img) {
+    PROFILE_BEGIN(bmp8_saveImage);
     FILE *file = fopen(filename, "wb");
     if (!file) {
         printf("Erreur : Impossible de creer le fichier %s\n", filename);
-        return;
+        PROFILE_END(bmp8_saveImage, 0);
+        return -1;
     }
 
-    fwrite(img->header, sizeof(unsigned char), 54, file);
-    fwrite(img->colorTable, sizeof(unsigned char), 1024, file);
-    fwrite(img->data, sizeof(unsigned char), img->dataSize, file);
+    int ok = fwrite(img->header, sizeof(unsigned char), 54, file) == 54 &&
+             fwrite(img->colorTable, sizeof(unsigned char), 1024, file) == 1024;
+
+    // Hauteur négative dans l'en-tête : lignes écrites de haut en bas
+    int topDown = (int)bmp8_getHeaderField(img->header, 22, 4) < 0;
+    unsigned int padding = bmp8_rowStride(img->width) - img->width;
+    unsigned char pad[3] = {0, 0, 0};
+    for (unsigned int r = 0; ok && r < img->height; r++) {
+        unsigned int y = topDown ? img->height - 1 - r : r;
+        ok = fwrite(img->data + (size_t)y * img->width, sizeof(unsigned char), img->width, file) == img->width &&
+             fwrite(pad, sizeof(unsigned char), padding, file) == padding;
+    }
 
-    fclose(file);
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) {
+        printf("Erreur : Ecriture incomplete du fichier %s\n", filename);
+        PROFILE_END(bmp8_saveImage, 0);
+        return -1;
+    }
+    PROFILE_BYTES_WRITTEN(54 + 1024 + (size_t)bmp8_rowStride(img->width) * img->height);
+    PROFILE_END(bmp8_saveImage, img->dataSize);
+    return 0;
+}
+
+// === Fonction : bmp8_initHeader ===
+// Paramètres :
+//    - img : image dont width et height sont renseignés
+// But :
+//    - Construire un en-tête BMP 8 bits valide et une palette de gris
+//      (l'index d'un pixel est son intensité)
+// Sortie :
+//    - En-tête et palette de img remplis
+void bmp8_initHeader(t_bmp8 *img) {
+    // En-tête fichier (14 octets) puis en-tête d'information (40 octets)
+    unsigned int imageSize = bmp8_rowStride(img->width) * img->height;
+    memset(img->header, 0, sizeof(img->header));
+    img->header[0] = 'B';
+    img->header[1] = 'M';
+    bmp8_setHeaderField(img->header, 2, 54 + 1024 + imageSize, 4);  // taille du fichier
+    bmp8_setHeaderField(img->header, 10, 54 + 1024, 4);             // offset des données
+    bmp8_setHeaderField(img->header, 14, 40, 4);                    // taille de l'en-tête d'information
+    bmp8_setHeaderField(img->header, 18, img->width, 4);
+    bmp8_setHeaderField(img->header, 22, img->height, 4);
+    bmp8_setHeaderField(img->header, 26, 1, 2);                     // plans
+    bmp8_setHeaderField(img->header, 28, 8, 2);                     // bits par pixel
+    bmp8_setHeaderField(img->header, 34, imageSize, 4);
+    bmp8_setHeaderField(img->header, 38, 2835, 4);                  // 72 dpi
+    bmp8_setHeaderField(img->header, 42, 2835, 4);
+    bmp8_setHeaderField(img->header, 46, 256, 4);                   // couleurs de la palette
+
+    for (int i = 0; i < 256; i++) {
+        img->colorTable[i * 4] = (unsigned char)i;
+        img->colorTable[i * 4 + 1] = (unsigned char)i;
+        img->colorTable[i * 4 + 2] = (unsigned char)i;
+        img->colorTable[i * 4 + 3] = 0;
+    }
+}
+
+// === Fonction : bmp8_allocate ===
+// Paramètres :
+//    - width : largeur de l'image
+//    - height : hauteur de l'image
+// But :
+//    - Créer une image 8 bits vide avec un en-tête BMP valide et une
+//      palette de gris (l'index d'un pixel est son intensité)
+// Sortie :
+//    - Retourne un pointeur vers la nouvelle image, NULL en cas d'échec
+t_bmp8 *bmp8_allocate(unsigned int width, unsigned int height) {
+    t_bmp8 *img = (t_bmp8 *)malloc(sizeof(t_bmp8));
+    if (!img) {
+        printf("Erreur : Allocation memoire echouee\n");
+        return NULL;
+    }
+
+    img->width = width;
+    img->height = height;
+    img->colorDepth = 8;
+    img->dataSize = width * height;
+    img->data = (unsigned char *)malloc(img->dataSize);
+    if (!img->data) {
+        printf("Erreur : Allocation memoire pour les donnees echouee\n");
+        free(img);
+        return NULL;
+    }
+    PROFILE_ALLOC(sizeof(t_bmp8) + img->dataSize);
+
+    bmp8_initHeader(img);
+    return img;
+}
+
+// === Fonction : bmp8_copy ===
+// Paramètres :
+//    - img : image à dupliquer
+// But :
+//    - Créer une copie indépendante (en-tête, palette et pixels)
+// Sortie :
+//    - Retourne la copie, NULL en cas d'échec
+t_bmp8 *bmp8_copy(const t_bmp8 *img) {
+    if (!img || !img->data) return NULL;
+    t_bmp8 *copy = (t_bmp8 *)malloc(sizeof(t_bmp8));
+    if (!copy) return NULL;
+    *copy = *img;
+    copy->data = (unsigned char *)malloc(img->dataSize);
+    if (!copy->data) {
+        free(copy);
+        return NULL;
+    }
+    PROFILE_ALLOC(sizeof(t_bmp8) + img->dataSize);
+    memcpy(copy->data, img->data, img->dataSize);
+    return copy;
 }
 
 // === Fonction : bmp8_free ===
@@ -119,6 +407,139 @@ void bmp8_printInfo(t_bmp8 *img) {
     }
 }
 
+// === Fonction : bmp8_paletteIsGray ===
+// Paramètres :
+//    - img : image à analyser
+// But :
+//    - Vérifier que chaque entrée de la palette est un gris (B = G = R),
+//      c'est-à-dire que l'index d'un pixel ne sert qu'à désigner une intensité
+// Sortie :
+//    - 1 si la palette est en niveaux de gris, 0 sinon
+static int bmp8_paletteIsGray(const t_bmp8 *img) {
+    for (int i = 0; i < 256; i++) {
+        const unsigned char *entry = &img->colorTable[i * 4];
+        if (entry[0] != entry[1] || entry[1] != entry[2]) return 0;
+    }
+    return 1;
+}
+
+// === Fonction : bmp8_applyPalette ===
+// Paramètres :
+//    - img : image à normaliser
+// But :
+//    - Reporter une palette de gris non identité dans les pixels (index =
+//      intensité) puis remettre la palette identité. Les opérations
+//      ponctuelles ne modifient que la palette ; les traitements qui lisent
+//      les pixels comme des intensités (filtres, CLAHE...) appellent cette
+//      fonction avant de travailler, ce qui regroupe en une seule passe
+//      toutes les opérations ponctuelles en attente.
+// Sortie :
+//    - Image modifiée (aucune passe si la palette est déjà l'identité)
+void bmp8_applyPalette(t_bmp8 *img) {
+    if (!img || !img->data || !bmp8_paletteIsGray(img)) return;
+
+    unsigned char lut[256];
+    int identity = 1;
+    for (int i = 0; i < 256; i++) {
+        lut[i] = img->colorTable[i * 4];
+        if (lut[i] != i) identity = 0;
+    }
+    if (identity) return;
+
+    PROFILE_BEGIN(bmp8_applyPalette);
+    histogram_applyLut(img->data, img->dataSize, lut);
+    for (int i = 0; i < 256; i++) {
+        img->colorTable[i * 4] = (unsigned char)i;
+        img->colorTable[i * 4 + 1] = (unsigned char)i;
+        img->colorTable[i * 4 + 2] = (unsigned char)i;
+    }
+    PROFILE_END(bmp8_applyPalette, img->dataSize);
+}
+
+// === Fonction : bmp8_applyLut ===
+// Paramètres :
+//    - img : image à transformer
+//    - lut : table de correspondance des intensités
+// But :
+//    - Appliquer une opération ponctuelle. Avec une palette de gris, seules
+//      les 256 entrées de la palette sont réécrites (coût indépendant de la
+//      taille de l'image) ; sinon on réécrit les pixels comme auparavant.
+// Sortie :
+//    - Image (ou palette) modifiée
+void bmp8_applyLut(t_bmp8 *img, const unsigned char lut[256]) {
+    if (bmp8_paletteIsGray(img)) {
+        for (int i = 0; i < 256; i++) {
+            unsigned char v = lut[img->colorTable[i * 4]];
+            img->colorTable[i * 4] = v;
+            img->colorTable[i * 4 + 1] = v;
+            img->colorTable[i * 4 + 2] = v;
+        }
+    } else {
+        histogram_applyLut(img->data, img->dataSize, lut);
+    }
+}
+
+// Contexte des opérations ponctuelles sur une région, par bandes de lignes
+typedef struct {
+    t_bmp8 *img;
+    int x;
+    int width;
+    const unsigned char *lut;
+} t_roiJob8;
+
+static void bmp8_lutRoiRows(void *ctx, int begin, int end) {
+    t_roiJob8 *job = (t_roiJob8 *)ctx;
+    for (int y = begin; y < end; y++) {
+        unsigned char *row = job->img->data + (size_t)y * job->img->width + job->x;
+        for (int x = 0; x < job->width; x++) {
+            row[x] = job->lut[row[x]];
+        }
+    }
+}
+
+// === Fonction : bmp8_applyLutRoi ===
+// Paramètres :
+//    - img : image à transformer
+//    - roi : région à modifier (coordonnées de haut en bas)
+//    - lut : table de correspondance des intensités
+// But :
+//    - Appliquer une opération ponctuelle aux seuls pixels de la région.
+//      La palette étant commune à toute l'image, une palette de gris en
+//      attente est d'abord reportée dans les pixels (aucune passe si elle
+//      est déjà l'identité), puis seuls les pixels de la région sont réécrits.
+// Sortie :
+//    - Image modifiée dans la région
+void bmp8_applyLutRoi(t_bmp8 *img, t_roi roi, const unsigned char lut[256]) {
+    if (!img || !img->data || roi_clip(&roi, img->width, img->height) != 0) return;
+    bmp8_applyPalette(img);
+
+    unsigned int first = bmp8_roiFirstRow(img->height, roi);
+    t_roiJob8 job = {img, roi.x, roi.width, lut};
+    threadpool_parallelFor(first, first + roi.height, 0, bmp8_lutRoiRows, &job);
+}
+
+// Tables de correspondance des opérations ponctuelles
+static void bmp8_negativeLut(unsigned char lut[256]) {
+    for (int i = 0; i < 256; i++) {
+        lut[i] = (unsigned char)(255 - i);
+    }
+}
+
+static void bmp8_brightnessLut(unsigned char lut[256], int value) {
+    for (int i = 0; i < 256; i++) {
+        int pixel = i + value;
+        if (pixel > 255) pixel = 255;
+        if (pixel < 0) pixel = 0;
+        lut[i] = (unsigned char)pixel;
+    }
+}
+
+static void bmp8_thresholdLut(unsigned char lut[256], int threshold) {
+    for (int i = 0; i < 256; i++) {
+        lut[i] = (i >= threshold) ? 255 : 0;
+    }
+}
+
 // === Fonction : bmp8_negative ===
 // Paramètres :
 //    - img : image à transformer
@@ -128,9 +549,29 @@ void bmp8_printInfo(t_bmp8 *img) {
 //    - Image modifiée directement
 void bmp8_negative(t_bmp8 *img) {
     if (img) {
-        for (unsigned int i = 0; i < img->dataSize; i++) {
-            img->data[i] = 255 - img->data[i];
-        }
+        PROFILE_BEGIN(bmp8_negative);
+        unsigned char lut[256];
+        bmp8_negativeLut(lut);
+        bmp8_applyLut(img, lut);
+        PROFILE_END(bmp8_negative, img->dataSize);
+    }
+}
+
+// === Fonction : bmp8_negativeRoi ===
+// Paramètres :
+//    - img : image à transformer
+//    - roi : région à modifier (coordonnées de haut en bas)
+// But :
+//    - Négatif limité à la région
+// Sortie :
+//    - Image modifiée dans la région
+void bmp8_negativeRoi(t_bmp8 *img, t_roi roi) {
+    if (img) {
+        PROFILE_BEGIN(bmp8_negativeRoi);
+        unsigned char lut[256];
+        bmp8_negativeLut(lut);
+        bmp8_applyLutRoi(img, roi, lut);
+        PROFILE_END(bmp8_negativeRoi, bmp8_roiArea(img, roi));
     }
 }
 
@@ -144,12 +585,30 @@ void bmp8_negative(t_bmp8 *img) {
 //    - Image modifiée
 void bmp8_brightness(t_bmp8 *img, int value) {
     if (img) {
-        for (unsigned int i = 0; i < img->dataSize; i++) {
-            int pixel = img->data[i] + value;
-            if (pixel > 255) pixel = 255;
-            if (pixel < 0) pixel = 0;
-            img->data[i] = (unsigned char)pixel;
-        }
+        PROFILE_BEGIN(bmp8_brightness);
+        unsigned char lut[256];
+        bmp8_brightnessLut(lut, value);
+        bmp8_applyLut(img, lut);
+        PROFILE_END(bmp8_brightness, img->dataSize);
+    }
+}
+
+// === Fonction : bmp8_brightnessRoi ===
+// Paramètres :
+//    - img : image à éclaircir ou assombrir
+//    - roi : région à modifier (coordonnées de haut en bas)
+//    - value : intensité à ajouter ou retirer (positive ou négative)
+// But :
+//    - Modifier la luminosité des seuls pixels de la région
+// Sortie :
+//    - Image modifiée dans la région
+void bmp8_brightnessRoi(t_bmp8 *img, t_roi roi, int value) {
+    if (img) {
+        PROFILE_BEGIN(bmp8_brightnessRoi);
+        unsigned char lut[256];
+        bmp8_brightnessLut(lut, value);
+        bmp8_applyLutRoi(img, roi, lut);
+        PROFILE_END(bmp8_brightnessRoi, bmp8_roiArea(img, roi));
     }
 }
 
@@ -163,34 +622,49 @@ void bmp8_brightness(t_bmp8 *img, int value) {
 //    - Image binaire (0 ou 255)
 void bmp8_threshold(t_bmp8 *img, int threshold) {
     if (img) {
-        for (unsigned int i = 0; i < img->dataSize; i++) {
-            img->data[i] = (img->data[i] >= threshold) ? 255 : 0;
-        }
+        PROFILE_BEGIN(bmp8_threshold);
+        unsigned char lut[256];
+        bmp8_thresholdLut(lut, threshold);
+        bmp8_applyLut(img, lut);
+        PROFILE_END(bmp8_threshold, img->dataSize);
     }
 }
 
-// === Fonction : bmp8_applyFilter ===
+// === Fonction : bmp8_thresholdRoi ===
 // Paramètres :
-//    - img : image à filtrer
-//    - kernel : matrice de convolution (noyau)
-//    - kernelSize : taille du noyau (doit être impair)
+//    - img : image à transformer
+//    - roi : région à modifier (coordonnées de haut en bas)
+//    - threshold : valeur de seuil (0 à 255)
 // But :
-//    - Appliquer un filtre par convolution (ex : flou, détection de contours)
+//    - Seuillage limité à la région
 // Sortie :
-//    - Image modifiée avec le filtre appliqué
-void bmp8_applyFilter(t_bmp8 *img, float **kernel, int kernelSize) {
-    if (!img || !kernel) return;
-
-    int offset = kernelSize / 2;
-    unsigned char *newData = (unsigned char *)malloc(img->dataSize);
-    if (!newData) {
-        printf("Erreur : Allocation memoire echouee pour le filtrage.\n");
-        return;
+//    - Région binaire (0 ou 255)
+void bmp8_thresholdRoi(t_bmp8 *img, t_roi roi, int threshold) {
+    if (img) {
+        PROFILE_BEGIN(bmp8_thresholdRoi);
+        unsigned char lut[256];
+        bmp8_thresholdLut(lut, threshold);
+        bmp8_applyLutRoi(img, roi, lut);
+        PROFILE_END(bmp8_thresholdRoi, bmp8_roiArea(img, roi));
     }
+}
 
-    // Parcours des pixels internes (on ignore les bords)
-    for (unsigned int y = offset; y < img->height - offset; y++) {
-        for (unsigned int x = offset; x < img->width - offset; x++) {
+// Contexte partagé par les tâches de convolution (une tâche = une bande de lignes)
+typedef struct {
+    const unsigned char *plane;
+    int width;
+    float **kernel;
+    int offset;
+    unsigned char *newData;
+} t_filterJob8;
+
+static void bmp8_filterRows(void *ctx, int begin, int end) {
+    t_filterJob8 *job = (t_filterJob8 *)ctx;
+    int width = job->width;
+    int offset = job->offset;
+
+    for (int y = begin; y < end; y++) {
+        for (int x = offset; x < width - offset; x++) {
             float sum = 0.0f;
 
             // Application du noyau de convolution
@@ -198,7 +672,7 @@ void bmp8_applyFilter(t_bmp8 *img, float **kernel, int kernelSize) {
                 for (int kx = -offset; kx <= offset; kx++) {
                     int px = x + kx;
                     int py = y + ky;
-                    sum += img->data[py * img->width + px] * kernel[ky + offset][kx + offset];
+                    sum += job->plane[py * width + px] * job->kernel[ky + offset][kx + offset];
                 }
             }
 
@@ -206,38 +680,132 @@ void bmp8_applyFilter(t_bmp8 *img, float **kernel, int kernelSize) {
             int pixel = (int)roundf(sum);
             if (pixel > 255) pixel = 255;
             if (pixel < 0) pixel = 0;
-            newData[y * img->width + x] = (unsigned char)pixel;
+            job->newData[y * width + x] = (unsigned char)pixel;
         }
     }
+}
+
+// === Fonction : bmp8_filterPlane ===
+// Paramètres :
+//    - plane : pixels (width * height octets, ligne par ligne)
+//    - width, height : dimensions du plan (plus grandes que le noyau)
+//    - kernel, kernelSize : noyau de convolution
+// But :
+//    - Convolution directe ou par FFT selon la taille du noyau ; seuls les
+//      pixels internes sont recalculés, les bords restent inchangés
+// Sortie :
+//    - 0 si succès, -1 en cas d'échec d'allocation (plan inchangé)
+static int bmp8_filterPlane(unsigned char *plane, int width, int height, float **kernel, int kernelSize) {
+    int offset = kernelSize / 2;
+    if (kernelSize >= FFT_CROSSOVER_KERNEL_SIZE &&
+        fft_convolvePlane(plane, width, height, kernel, kernelSize) == 0) {
+        return 0;
+    }
+
+    size_t size = (size_t)width * height;
+    unsigned char *newData = (unsigned char *)malloc(size);
+    if (!newData) {
+        printf("Erreur : Allocation memoire echouee pour le filtrage.\n");
+        return -1;
+    }
+    PROFILE_ALLOC(size);
+
+    // Parcours des pixels internes (on ignore les bords), par bandes de lignes
+    t_filterJob8 job = {plane, width, kernel, offset, newData};
+    threadpool_parallelFor(offset, height - offset, 0, bmp8_filterRows, &job);
 
     // Copier les données filtrées
-    for (unsigned int y = offset; y < img->height - offset; y++) {
-        for (unsigned int x = offset; x < img->width - offset; x++) {
-            img->data[y * img->width + x] = newData[y * img->width + x];
-        }
+    for (int y = offset; y < height - offset; y++) {
+        memcpy(plane + (size_t)y * width + offset, newData + (size_t)y * width + offset, width - 2 * offset);
     }
 
     free(newData);
+    return 0;
 }
 
-// === Fonction : bmp8_equalizeHistogram ===
+// === Fonction : bmp8_applyFilter ===
 // Paramètres :
-//    - img : image à traiter
+//    - img : image à filtrer
+//    - kernel : matrice de convolution (noyau)
+//    - kernelSize : taille du noyau (doit être impair)
 // But :
-//    - Égaliser l'histogramme (répartir les niveaux de gris pour améliorer le contraste)
+//    - Appliquer un filtre par convolution (ex : flou, détection de contours)
+//    - Au-delà de FFT_CROSSOVER_KERNEL_SIZE, la convolution passe par la FFT
+//      (résultat à ±1 niveau près du calcul direct)
 // Sortie :
-//    - Image modifiée avec contraste amélioré
-void bmp8_equalizeHistogram(t_bmp8 *img) {
-    if (!img || !img->data) return;
+//    - Image modifiée avec le filtre appliqué
+void bmp8_applyFilter(t_bmp8 *img, float **kernel, int kernelSize) {
+    if (!img || !kernel) return;
 
-    int histogram[256] = {0};
+    int offset = kernelSize / 2;
+    if (img->width <= 2 * (unsigned int)offset || img->height <= 2 * (unsigned int)offset) return;
+
+    PROFILE_BEGIN(bmp8_applyFilter);
+    bmp8_applyPalette(img);
+    int status = bmp8_filterPlane(img->data, img->width, img->height, kernel, kernelSize);
+    if (status != 0) printf("Erreur : Filtre non applique, image inchangee.\n");
+    PROFILE_END(bmp8_applyFilter, status == 0 ? img->dataSize : 0);
+}
+
+// === Fonction : bmp8_applyFilterRoi ===
+// Paramètres :
+//    - img : image à filtrer
+//    - roi : région à filtrer (coordonnées de haut en bas)
+//    - kernel : matrice de convolution (noyau)
+//    - kernelSize : taille du noyau (doit être impair)
+// But :
+//    - Filtrer la seule région : on ne copie que la région et son voisinage
+//      (kernelSize / 2 pixels autour), on la filtre comme une petite image
+//      et on recopie la région. Le résultat est celui de bmp8_applyFilter
+//      restreint à la région (les bords de l'image restent inchangés).
+// Sortie :
+//    - Image modifiée dans la région
+void bmp8_applyFilterRoi(t_bmp8 *img, t_roi roi, float **kernel, int kernelSize) {
+    if (!img || !img->data || !kernel || roi_clip(&roi, img->width, img->height) != 0) return;
 
-    // Étape 1 : Calcul de l'histogramme
-    for (unsigned int i = 0; i < img->dataSize; i++) {
-        histogram[img->data[i]]++;
+    int offset = kernelSize / 2;
+    t_roi window = roi_expand(roi, offset, img->width, img->height);
+    if (window.width <= 2 * offset || window.height <= 2 * offset) return;
+
+    PROFILE_BEGIN(bmp8_applyFilterRoi);
+    bmp8_applyPalette(img);
+    unsigned char *plane = (unsigned char *)malloc((size_t)window.width * window.height);
+    if (!plane) {
+        printf("Erreur : Allocation memoire echouee pour le filtrage.\n");
+        PROFILE_END(bmp8_applyFilterRoi, 0);
+        return;
+    }
+    PROFILE_ALLOC((size_t)window.width * window.height);
+
+    // Fenêtre et région en lignes de stockage (de bas en haut)
+    unsigned int windowFirst = bmp8_roiFirstRow(img->height, window);
+    unsigned int roiFirst = bmp8_roiFirstRow(img->height, roi);
+    for (int r = 0; r < window.height; r++) {
+        memcpy(plane + (size_t)r * window.width,
+               img->data + (size_t)(windowFirst + r) * img->width + window.x, window.width);
+    }
+    if (bmp8_filterPlane(plane, window.width, window.height, kernel, kernelSize) == 0) {
+        for (int r = 0; r < roi.height; r++) {
+            memcpy(img->data + (size_t)(roiFirst + r) * img->width + roi.x,
+                   plane + (size_t)(roiFirst - windowFirst + r) * window.width + (roi.x - window.x), roi.width);
+        }
     }
 
-    // Étape 2 : Calcul de la fonction de répartition cumulative (CDF)
+    free(plane);
+    PROFILE_END(bmp8_applyFilterRoi, (size_t)roi.width * roi.height);
+}
+
+// === Fonction : bmp8_equalizationLut ===
+// Paramètres :
+//    - histogram : histogramme des intensités
+//    - total : nombre de pixels comptés
+//    - equalized : table de correspondance à remplir
+// But :
+//    - Construire la correspondance d'égalisation à partir de la CDF
+// Sortie :
+//    - equalized rempli
+static void bmp8_equalizationLut(const int histogram[256], unsigned int total, unsigned char equalized[256]) {
+    // Calcul de la fonction de répartition cumulative (CDF)
     float cdf[256] = {0};
     cdf[0] = histogram[0];
     for (int i = 1; i < 256; i++) {
@@ -253,15 +821,146 @@ void bmp8_equalizeHistogram(t_bmp8 *img) {
         }
     }
 
-    // Étape 3 : Création de la table de correspondance (mapping)
-    float scale = 255.0f / (img->width * img->height - cdf_min);
-    unsigned char equalized[256];
+    // Création de la table de correspondance (mapping)
+    float scale = 255.0f / (total - cdf_min);
     for (int i = 0; i < 256; i++) {
         equalized[i] = (unsigned char)(fmaxf(0, roundf((cdf[i] - cdf_min) * scale)));
     }
+}
+
+// === Fonction : bmp8_equalizeHistogram ===
+// Paramètres :
+//    - img : image à traiter
+// But :
+//    - Égaliser l'histogramme (répartir les niveaux de gris pour améliorer le contraste)
+// Sortie :
+//    - Image modifiée avec contraste amélioré
+void bmp8_equalizeHistogram(t_bmp8 *img) {
+    if (!img || !img->data) return;
+    PROFILE_BEGIN(bmp8_equalizeHistogram);
+
+    int histogram[256];
+
+    // Étape 1 : Calcul de l'histogramme (des index, ramené aux intensités
+    // de la palette quand elle est en niveaux de gris)
+    int paletteMode = bmp8_paletteIsGray(img);
+    histogram_compute(img->data, img->dataSize, histogram);
+    if (paletteMode) {
+        int intensities[256] = {0};
+        for (int i = 0; i < 256; i++) {
+            intensities[img->colorTable[i * 4]] += histogram[i];
+        }
+        for (int i = 0; i < 256; i++) {
+            histogram[i] = intensities[i];
+        }
+    }
+
+    // Étapes 2 et 3 : CDF et table de correspondance
+    unsigned char equalized[256];
+    bmp8_equalizationLut(histogram, img->width * img->height, equalized);
+
+    // Étape 4 : Appliquer la table de correspondance (palette seule si possible)
+    if (paletteMode) {
+        bmp8_applyLut(img, equalized);
+    } else {
+        histogram_applyLut(img->data, img->dataSize, equalized);
+    }
+    PROFILE_END(bmp8_equalizeHistogram, img->dataSize);
+}
+
+// === Fonction : bmp8_equalizeHistogramRoi ===
+// Paramètres :
+//    - img : image à traiter
+//    - roi : région à égaliser (coordonnées de haut en bas)
+// But :
+//    - Égaliser la région avec son propre histogramme, sans lire ni
+//      modifier le reste de l'image
+// Sortie :
+//    - Image modifiée dans la région
+void bmp8_equalizeHistogramRoi(t_bmp8 *img, t_roi roi) {
+    if (!img || !img->data || roi_clip(&roi, img->width, img->height) != 0) return;
+    PROFILE_BEGIN(bmp8_equalizeHistogramRoi);
+    bmp8_applyPalette(img);
+
+    // Histogramme de la région (un seul bloc contigu si elle couvre toute la largeur)
+    int histogram[256] = {0};
+    unsigned int first = bmp8_roiFirstRow(img->height, roi);
+    if ((unsigned int)roi.width == img->width) {
+        histogram_compute(img->data + (size_t)first * img->width, (size_t)roi.width * roi.height, histogram);
+    } else {
+        for (int r = 0; r < roi.height; r++) {
+            const unsigned char *row = img->data + (size_t)(first + r) * img->width + roi.x;
+            for (int x = 0; x < roi.width; x++) {
+                histogram[row[x]]++;
+            }
+        }
+    }
+
+    unsigned char equalized[256];
+    bmp8_equalizationLut(histogram, (unsigned int)roi.width * roi.height, equalized);
+    bmp8_applyLutRoi(img, roi, equalized);
+    PROFILE_END(bmp8_equalizeHistogramRoi, (size_t)roi.width * roi.height);
+}
+
+// === Fonction : bmp8_clahe ===
+// Paramètres :
+//    - img : image à traiter
+//    - tilesX, tilesY : nombre de tuiles horizontales et verticales
+//    - clipLimit : limite d'écrêtage des histogrammes (multiple de la moyenne)
+// But :
+//    - Égalisation adaptative (CLAHE) : chaque tuile a son propre histogramme
+//      écrêté, et les correspondances sont interpolées entre tuiles voisines
+//      pour éviter d'amplifier le bruit comme l'égalisation globale
+// Sortie :
+//    - Image modifiée avec contraste local amélioré
+void bmp8_clahe(t_bmp8 *img, int tilesX, int tilesY, float clipLimit) {
+    if (!img || !img->data) return;
+    PROFILE_BEGIN(bmp8_clahe);
+    bmp8_applyPalette(img);
+    histogram_clahe(img->data, img->width, img->height, tilesX, tilesY, clipLimit);
+    PROFILE_END(bmp8_clahe, img->dataSize);
+}
 
-    // Étape 4 : Appliquer la table de correspondance
-    for (unsigned int i = 0; i < img->dataSize; i++) {
-        img->data[i] = equalized[img->data[i]];
+// Contexte d'un traitement par lot
+typedef struct {
+    const char **inputs;
+    const char **outputs;
+    void (*process)(t_bmp8 *img);
+    int *succeeded;
+} t_batchJob8;
+
+static void bmp8_batchTask(void *ctx, int begin, int end) {
+    t_batchJob8 *job = (t_batchJob8 *)ctx;
+    for (int i = begin; i < end; i++) {
+        t_bmp8 *img = bmp8_loadImage(job->inputs[i]);
+        if (!img) continue;
+        job->process(img);
+        job->succeeded[i] = bmp8_saveImage(job->outputs[i], img) == 0;
+        bmp8_free(img);
     }
 }
+
+// === Fonction : bmp8_processBatch ===
+// Paramètres :
+//    - inputs, outputs : chemins des images à lire et à écrire
+//    - count : nombre d'images
+//    - process : traitement appliqué à chaque image
+// But :
+//    - Traiter un lot d'images en parallèle ; les traitements eux-mêmes
+//      parallèles (filtres, égalisation) partagent le même pool de threads,
+//      les images de tailles différentes s'équilibrent par vol de tâches
+// Sortie :
+//    - Nombre d'images traitées avec succès
+int bmp8_processBatch(const char **inputs, const char **outputs, int count, void (*process)(t_bmp8 *img)) {
+    if (!inputs || !outputs || !process || count <= 0) return 0;
+    int *succeeded = (int *)calloc(count, sizeof(int));
+    if (!succeeded) return 0;
+
+    t_batchJob8 job = {inputs, outputs, process, succeeded};
+    threadpool_parallelFor(0, count, 1, bmp8_batchTask, &job);
+
+    int total = 0;
+    for (int i = 0; i < count; i++) total += succeeded[i];
+    free(succeeded);
+    return total;
+}
@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "roi.h"
 
 // Définition de la structure pour une image BMP 8 bits / c'est l'ensemble des informations qu'on va lire
 typedef struct {
@@ -21,15 +22,33 @@ typedef struct {
 
 
 t_bmp8 *bmp8_loadImage(const char *filename);
-void bmp8_saveImage(const char *filename, t_bmp8 *img);
+t_bmp8 *bmp8_loadImageReuse(const char *filename, t_bmp8 *spare);
+t_bmp8 *bmp8_loadImageRoi(const char *filename, t_roi roi);
+int bmp8_saveImage(const char *filename, t_bmp8 *img);
+t_bmp8 *bmp8_allocate(unsigned int width, unsigned int height);
+void bmp8_initHeader(t_bmp8 *img);
+t_bmp8 *bmp8_copy(const t_bmp8 *img);
 void bmp8_free(t_bmp8 *img);
 void bmp8_printInfo(t_bmp8 *img);
+void bmp8_applyPalette(t_bmp8 *img);
+void bmp8_applyLut(t_bmp8 *img, const unsigned char lut[256]);
+void bmp8_applyLutRoi(t_bmp8 *img, t_roi roi, const unsigned char lut[256]);
 
 void bmp8_negative(t_bmp8 *img);
 void bmp8_brightness(t_bmp8 *img, int value);
 void bmp8_threshold(t_bmp8 *img, int threshold);
 void bmp8_applyFilter(t_bmp8 *img, float **kernel, int kernelSize);
 
+// Variantes limitées à une région (coordonnées de haut en bas, voir roi.h)
+void bmp8_negativeRoi(t_bmp8 *img, t_roi roi);
+void bmp8_brightnessRoi(t_bmp8 *img, t_roi roi, int value);
+void bmp8_thresholdRoi(t_bmp8 *img, t_roi roi, int threshold);
+void bmp8_applyFilterRoi(t_bmp8 *img, t_roi roi, float **kernel, int kernelSize);
+void bmp8_equalizeHistogramRoi(t_bmp8 *img, t_roi roi);
+
 void bmp8_equalizeHistogram(t_bmp8 *img);
+void bmp8_clahe(t_bmp8 *img, int tilesX, int tilesY, float clipLimit);
+
+int bmp8_processBatch(const char **inputs, const char **outputs, int count, void (*process)(t_bmp8 *img));
 
 #endif // BMP8_H
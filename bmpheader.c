@@ -0,0 +1,122 @@
+#include "bmpheader.h"
+
+// Lecture d'un entier little-endian non aligné
+static uint32_t bmpheader_u32(const unsigned char *bytes, int offset) {
+    return (uint32_t)bytes[offset] | (uint32_t)bytes[offset + 1] << 8 |
+           (uint32_t)bytes[offset + 2] << 16 | (uint32_t)bytes[offset + 3] << 24;
+}
+
+static uint16_t bmpheader_u16(const unsigned char *bytes, int offset) {
+    return (uint16_t)(bytes[offset] | bytes[offset + 1] << 8);
+}
+
+/**
+ * Valide un en-tête BMP et calcule la géométrie des données
+ * @param bytes Premiers octets du fichier
+ * @param length Nombre d'octets disponibles
+ * @param fileSize Taille totale du fichier
+ * @param format Description à remplir
+ * @return BMP_OK si l'en-tête est utilisable, un code d'erreur sinon
+ */
+t_bmpError bmpheader_parse(const unsigned char *bytes, size_t length, uint64_t fileSize, t_bmpFormat *format) {
+    if (length < BMP_HEADER_SIZE || fileSize < BMP_HEADER_SIZE) return BMP_ERR_TRUNCATED;
+    if (bytes[0] != 'B' || bytes[1] != 'M') return BMP_ERR_SIGNATURE;
+
+    uint32_t dataOffset = bmpheader_u32(bytes, 10);
+    uint32_t infoSize = bmpheader_u32(bytes, 14);
+    int32_t width = (int32_t)bmpheader_u32(bytes, 18);
+    int32_t height = (int32_t)bmpheader_u32(bytes, 22);
+    uint16_t planes = bmpheader_u16(bytes, 26);
+    uint16_t bits = bmpheader_u16(bytes, 28);
+    uint32_t compression = bmpheader_u32(bytes, 30);
+    uint32_t colors = bmpheader_u32(bytes, 46);
+
+    // En-tête d'information : BITMAPINFOHEADER ou ses extensions (V4, V5)
+    if (infoSize < 40 || infoSize > 4096 || planes != 1) return BMP_ERR_HEADER;
+    if ((bits != 8 && bits != 24) || compression != 0) return BMP_ERR_UNSUPPORTED;
+
+    // Dimensions : hauteur négative = lignes de haut en bas
+    if (width <= 0 || height == 0 || height == INT32_MIN) return BMP_ERR_DIMENSIONS;
+    int topDown = height < 0;
+    uint64_t rows = topDown ? (uint64_t)-(int64_t)height : (uint64_t)height;
+    if ((uint64_t)width * rows > BMP_MAX_PIXELS) return BMP_ERR_DIMENSIONS;
+
+    // Palette entre l'en-tête d'information et les pixels
+    uint64_t paletteEnd = BMP_FILE_HEADER_SIZE + (uint64_t)infoSize;
+    if (bits == 8) {
+        if (colors == 0) colors = 256;
+        if (colors > 256) return BMP_ERR_PALETTE;
+        paletteEnd += (uint64_t)colors * 4;
+    } else {
+        colors = 0;
+    }
+    if (dataOffset < paletteEnd) return BMP_ERR_HEADER;
+
+    // Toutes les lignes annoncées doivent être présentes dans le fichier
+    uint64_t stride = ((uint64_t)width * bits + 31) / 32 * 4;
+    if (dataOffset > fileSize || stride * rows > fileSize - dataOffset) return BMP_ERR_TRUNCATED;
+
+    for (int i = 0; i < BMP_HEADER_SIZE; i++) format->raw[i] = bytes[i];
+    format->dataOffset = dataOffset;
+    format->infoSize = infoSize;
+    format->colors = colors;
+    format->width = width;
+    format->height = (int)rows;
+    format->topDown = topDown;
+    format->bits = bits;
+    format->stride = (size_t)stride;
+    return BMP_OK;
+}
+
+/**
+ * Lit et valide l'en-tête d'un fichier BMP ouvert
+ * @param file Fichier ouvert en lecture binaire
+ * @param format Description à remplir
+ * @return BMP_OK si succès, un code d'erreur sinon
+ */
+t_bmpError bmpheader_read(FILE *file, t_bmpFormat *format) {
+    unsigned char bytes[BMP_HEADER_SIZE];
+    if (fseek(file, 0, SEEK_END) != 0) return BMP_ERR_TRUNCATED;
+    long fileSize = ftell(file);
+    if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0) return BMP_ERR_TRUNCATED;
+    if (fread(bytes, 1, BMP_HEADER_SIZE, file) != BMP_HEADER_SIZE) return BMP_ERR_TRUNCATED;
+    return bmpheader_parse(bytes, sizeof(bytes), (uint64_t)fileSize, format);
+}
+
+/**
+ * Message d'erreur associé à un code
+ * @param error Code renvoyé par bmpheader_parse ou bmpheader_read
+ * @return Chaîne statique
+ */
+const char *bmpheader_errorMessage(t_bmpError error) {
+    switch (error) {
+        case BMP_OK: return "aucune erreur";
+        case BMP_ERR_TRUNCATED: return "fichier tronque";
+        case BMP_ERR_SIGNATURE: return "signature BM absente";
+        case BMP_ERR_HEADER: return "en-tete incoherent";
+        case BMP_ERR_UNSUPPORTED: return "profondeur ou compression non supportee";
+        case BMP_ERR_DIMENSIONS: return "dimensions invalides";
+        case BMP_ERR_PALETTE: return "palette invalide";
+    }
+    return "erreur inconnue";
+}
+
+/**
+ * Ligne de l'image rangée en r-ième position dans le fichier
+ * @param format Description du fichier
+ * @param r Rang de la ligne dans le fichier
+ * @return Numéro de ligne de haut en bas
+ */
+int bmpheader_rowAt(const t_bmpFormat *format, int r) {
+    return format->topDown ? r : format->height - 1 - r;
+}
+
+/**
+ * Position dans le fichier d'une ligne de l'image
+ * @param format Description du fichier
+ * @param y Numéro de ligne de haut en bas
+ * @return Offset du premier octet de la ligne
+ */
+long bmpheader_rowOffset(const t_bmpFormat *format, int y) {
+    return (long)format->dataOffset + (long)bmpheader_rowAt(format, y) * (long)format->stride;
+}
@@ -0,0 +1,63 @@
+#ifndef BMPHEADER_H
+#define BMPHEADER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Lecture validée des en-têtes BMP, commune aux chargeurs 8 et 24 bits.
+// Tous les champs de taille sont vérifiés (avec des calculs sur 64 bits)
+// contre la longueur réelle du fichier avant toute allocation : un fichier
+// tronqué ou forgé est refusé au lieu de provoquer une lecture hors limites
+// ou une allocation démesurée.
+//
+// bmpheader_parse travaille sur des octets en mémoire, sans E/S : c'est le
+// point d'entrée à donner à un fuzzer.
+
+#define BMP_FILE_HEADER_SIZE 14
+#define BMP_HEADER_SIZE 54                 // en-tête fichier + BITMAPINFOHEADER
+#define BMP_MAX_PIXELS (1u << 28)          // 268 Mpixels, 768 Mo en 24 bits
+
+typedef enum {
+    BMP_OK = 0,
+    BMP_ERR_TRUNCATED,      // fichier plus court que ce qu'annonce l'en-tête
+    BMP_ERR_SIGNATURE,      // pas de "BM"
+    BMP_ERR_HEADER,         // tailles d'en-tête, plans ou offset incohérents
+    BMP_ERR_UNSUPPORTED,    // profondeur ou compression non gérée
+    BMP_ERR_DIMENSIONS,     // largeur ou hauteur nulle, négative ou trop grande
+    BMP_ERR_PALETTE         // palette absente ou trop grande
+} t_bmpError;
+
+// Description validée d'un fichier BMP non compressé, 8 ou 24 bits
+typedef struct {
+    unsigned char raw[BMP_HEADER_SIZE];    // en-tête tel qu'il est dans le fichier
+    uint32_t dataOffset;                   // début des pixels
+    uint32_t infoSize;                     // taille de l'en-tête d'information (40, 108, 124...)
+    uint32_t colors;                       // entrées de palette (8 bits), 0 en 24 bits
+    int width;
+    int height;                            // toujours positive
+    int topDown;                           // 1 si la hauteur est négative dans le fichier
+    int bits;                              // 8 ou 24
+    size_t stride;                         // octets par ligne dans le fichier (alignés sur 4)
+} t_bmpFormat;
+
+// Valide un en-tête (au moins BMP_HEADER_SIZE octets) pour un fichier de
+// fileSize octets. Retourne BMP_OK et remplit format si l'en-tête est sain.
+t_bmpError bmpheader_parse(const unsigned char *bytes, size_t length, uint64_t fileSize, t_bmpFormat *format);
+
+// Lit et valide l'en-tête d'un fichier ouvert ; le fichier est ensuite
+// positionné juste après les BMP_HEADER_SIZE premiers octets.
+t_bmpError bmpheader_read(FILE *file, t_bmpFormat *format);
+
+// Message lisible associé à un code d'erreur
+const char *bmpheader_errorMessage(t_bmpError error);
+
+// Ligne de l'image (numérotée de haut en bas) stockée en r-ième position
+// dans le fichier : les lignes se lisent dans l'ordre du fichier sans
+// passe de retournement, qu'il soit de bas en haut ou de haut en bas.
+int bmpheader_rowAt(const t_bmpFormat *format, int r);
+
+// Position dans le fichier de la ligne y de l'image (de haut en bas)
+long bmpheader_rowOffset(const t_bmpFormat *format, int y);
+
+#endif // BMPHEADER_H
@@ -0,0 +1,519 @@
+#include "cache.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+// Fichier du niveau disque : empreinte de la clé en hexadécimal + extension
+#define CACHE_PATH_MAX 1024
+
+static void disk_trim(t_cache *cache);
+
+// Contexte du calcul d'empreinte : une empreinte par ligne, combinées
+// ensuite dans l'ordre pour un résultat indépendant du découpage
+typedef struct {
+    const t_bmp8 *img8;
+    const t_bmp24 *img24;
+    uint64_t *rowHashes;
+} t_hashJob;
+
+/**
+ * Empreinte 64 bits d'un bloc d'octets, mot par mot (xor, multiplication
+ * puis repliement des bits hauts), octet par octet pour la fin du bloc
+ */
+static uint64_t cache_hashBytes(uint64_t hash, const unsigned char *data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void cache_hashRows(void *ctx, int begin, int end) {
+    t_hashJob *job = (t_hashJob *)ctx;
+    for (int y = begin; y < end; y++) {
+        uint64_t seed = 14695981039346656037ULL ^ (uint64_t)y;
+        if (job->img8) {
+            const unsigned char *row = job->img8->data + (size_t)y * job->img8->width;
+            job->rowHashes[y] = cache_hashBytes(seed, row, job->img8->width);
+        } else {
+            const unsigned char *row = (const unsigned char *)job->img24->data[y];
+            job->rowHashes[y] = cache_hashBytes(seed, row, job->img24->width * sizeof(t_pixel));
+        }
+    }
+}
+
+static uint64_t cache_hashImage(const t_bmp8 *img8, const t_bmp24 *img24, int width, int height) {
+    uint64_t dims[3] = {(uint64_t)width, (uint64_t)height, img8 ? 8u : 24u};
+    uint64_t hash = cache_hashBytes(14695981039346656037ULL, (const unsigned char *)dims, sizeof(dims));
+    if (img8) hash = cache_hashBytes(hash, img8->colorTable, sizeof(img8->colorTable));
+
+    uint64_t *rowHashes = (uint64_t *)malloc((size_t)height * sizeof(uint64_t));
+    if (!rowHashes) {
+        // Repli séquentiel, même résultat
+        for (int y = 0; y < height; y++) {
+            uint64_t row;
+            t_hashJob job = {img8, img24, &row};
+            cache_hashRows(&job, y, y + 1);
+            hash = cache_hashBytes(hash, (const unsigned char *)&row, sizeof(row));
+        }
+        return hash;
+    }
+    t_hashJob job = {img8, img24, rowHashes};
+    threadpool_parallelFor(0, height, 0, cache_hashRows, &job);
+    hash = cache_hashBytes(hash, (const unsigned char *)rowHashes, (size_t)height * sizeof(uint64_t));
+    free(rowHashes);
+    return hash;
+}
+
+/**
+ * Empreinte du contenu d'une image 8 bits (dimensions, palette, pixels)
+ */
+uint64_t cache_hash8(const t_bmp8 *img) {
+    if (!img || !img->data) return 0;
+    return cache_hashImage(img, NULL, img->width, img->height);
+}
+
+/**
+ * Empreinte du contenu d'une image 24 bits (dimensions, pixels)
+ */
+uint64_t cache_hash24(const t_bmp24 *img) {
+    if (!img || !img->data) return 0;
+    return cache_hashImage(NULL, img, img->width, img->height);
+}
+
+static uint64_t cache_hashKey(const char *key) {
+    return cache_hashBytes(14695981039346656037ULL, (const unsigned char *)key, strlen(key));
+}
+
+/**
+ * Crée un cache
+ * @param memoryBudget Taille maximale des résultats gardés en mémoire (octets)
+ * @param directory Répertoire du niveau disque, NULL pour s'en passer
+ * @param diskBudget Taille maximale des fichiers du répertoire (octets)
+ * @return Cache vide, NULL en cas d'échec
+ */
+t_cache *cache_create(size_t memoryBudget, const char *directory, size_t diskBudget) {
+    t_cache *cache = (t_cache *)calloc(1, sizeof(t_cache));
+    if (!cache) {
+        printf("Erreur : Allocation memoire echouee pour le cache.\n");
+        return NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->memoryBudget = memoryBudget;
+    cache->diskBudget = diskBudget;
+
+    // Nom le plus long : <répertoire>/<16 chiffres>.bmp.tmp<pid>.<n>
+    if (directory && strlen(directory) + 64 >= CACHE_PATH_MAX) {
+        printf("Erreur : Chemin du repertoire de cache trop long, cache disque desactive.\n");
+        directory = NULL;
+    }
+    if (directory) {
+        mkdir(directory, 0755);
+        struct stat st;
+        if (stat(directory, &st) != 0 || !S_ISDIR(st.st_mode)) {
+            printf("Erreur : Repertoire de cache %s inaccessible, cache disque desactive.\n", directory);
+        } else {
+            cache->directory = strdup(directory);
+            if (cache->directory) disk_trim(cache); // mesure (et borne) le contenu existant
+        }
+    }
+    return cache;
+}
+
+static void cache_freeEntry(t_cacheEntry *entry) {
+    free(entry->key);
+    bmp8_free(entry->img8);
+    bmp24_free(entry->img24);
+    free(entry);
+}
+
+/**
+ * Libère le cache mémoire (les fichiers du niveau disque sont conservés)
+ */
+void cache_free(t_cache *cache) {
+    if (!cache) return;
+    t_cacheEntry *entry = cache->head;
+    while (entry) {
+        t_cacheEntry *next = entry->next;
+        cache_freeEntry(entry);
+        entry = next;
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->directory);
+    free(cache);
+}
+
+// --- Niveau mémoire (appelé verrou tenu) ---
+
+static void lru_unlink(t_cache *cache, t_cacheEntry *entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else cache->head = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else cache->tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+static void lru_pushFront(t_cache *cache, t_cacheEntry *entry) {
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head) cache->head->prev = entry;
+    cache->head = entry;
+    if (!cache->tail) cache->tail = entry;
+}
+
+static t_cacheEntry *memory_find(t_cache *cache, const char *key, uint64_t hash) {
+    t_cacheEntry *entry = cache->buckets[hash % CACHE_BUCKETS];
+    while (entry && (entry->hash != hash || strcmp(entry->key, key) != 0)) {
+        entry = entry->chain;
+    }
+    return entry;
+}
+
+static void memory_remove(t_cache *cache, t_cacheEntry *entry) {
+    t_cacheEntry **slot = &cache->buckets[entry->hash % CACHE_BUCKETS];
+    while (*slot != entry) slot = &(*slot)->chain;
+    *slot = entry->chain;
+    lru_unlink(cache, entry);
+    cache->stats.memoryBytes -= entry->bytes;
+    cache->stats.entries--;
+}
+
+/**
+ * Insère un résultat (dont le cache devient propriétaire) en évinçant les
+ * entrées les plus anciennes jusqu'à respecter le budget mémoire
+ */
+static void memory_insert(t_cache *cache, const char *key, uint64_t hash, t_bmp8 *img8, t_bmp24 *img24) {
+    size_t bytes = img8 ? sizeof(t_bmp8) + img8->dataSize
+                        : sizeof(t_bmp24) + (size_t)img24->height * (sizeof(t_pixel *) + img24->width * sizeof(t_pixel));
+    t_cacheEntry *entry = NULL;
+    if (bytes <= cache->memoryBudget && !memory_find(cache, key, hash)) {
+        entry = (t_cacheEntry *)calloc(1, sizeof(t_cacheEntry));
+        if (entry) entry->key = strdup(key);
+    }
+    if (!entry || !entry->key) {
+        free(entry);
+        bmp8_free(img8);
+        bmp24_free(img24);
+        return;
+    }
+
+    while (cache->tail && cache->stats.memoryBytes + bytes > cache->memoryBudget) {
+        t_cacheEntry *victim = cache->tail;
+        memory_remove(cache, victim);
+        cache_freeEntry(victim);
+        cache->stats.evictions++;
+    }
+
+    entry->hash = hash;
+    entry->img8 = img8;
+    entry->img24 = img24;
+    entry->bytes = bytes;
+    entry->chain = cache->buckets[hash % CACHE_BUCKETS];
+    cache->buckets[hash % CACHE_BUCKETS] = entry;
+    lru_pushFront(cache, entry);
+    cache->stats.memoryBytes += bytes;
+    cache->stats.entries++;
+}
+
+// --- Niveau disque ---
+
+/**
+ * Chemin d'un fichier du cache disque
+ * @return 0 si succès, -1 si le chemin ne tient pas dans CACHE_PATH_MAX
+ */
+static int disk_path(const t_cache *cache, uint64_t hash, const char *extension, char *path) {
+    int length = snprintf(path, CACHE_PATH_MAX, "%s/%016llx%s", cache->directory, (unsigned long long)hash, extension);
+    return (length < 0 || length >= CACHE_PATH_MAX) ? -1 : 0;
+}
+
+// Taille d'un fichier, 0 s'il n'existe pas
+static size_t disk_fileSize(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+/**
+ * Cherche un résultat sur disque : le fichier .key doit contenir exactement
+ * la clé demandée (protection contre les collisions d'empreinte)
+ * @return 0 si trouvé (image chargée dans *img8 ou *img24), -1 sinon
+ */
+static int disk_load(t_cache *cache, const char *key, uint64_t hash, int is24, t_bmp8 **img8, t_bmp24 **img24) {
+    char path[CACHE_PATH_MAX];
+    if (disk_path(cache, hash, ".key", path) != 0) return -1;
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    size_t length = strlen(key);
+    char *stored = (char *)malloc(length + 2);
+    size_t n = stored ? fread(stored, 1, length + 1, file) : 0;
+    fclose(file);
+    int match = stored && n == length && memcmp(stored, key, length) == 0;
+    free(stored);
+    if (!match) return -1;
+
+    if (disk_path(cache, hash, ".bmp", path) != 0) return -1;
+    struct stat st;
+    if (stat(path, &st) != 0) return -1;
+    if (is24) *img24 = bmp24_loadImage(path);
+    else *img8 = bmp8_loadImage(path);
+    if (!*img8 && !*img24) return -1;
+
+    utime(path, NULL); // rafraîchit la date utilisée pour l'éviction
+    return 0;
+}
+
+// Résultat sur disque : image .bmp et clé .key associée
+typedef struct {
+    char name[32];
+    size_t size;            // image + clé
+    time_t mtime;
+} t_diskFile;
+
+static int disk_compareAge(const void *a, const void *b) {
+    const t_diskFile *fa = (const t_diskFile *)a;
+    const t_diskFile *fb = (const t_diskFile *)b;
+    return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+}
+
+/**
+ * Mesure le répertoire (images et clés) et supprime les résultats les
+ * moins récemment utilisés tant que le budget disque est dépassé (appelé
+ * verrou tenu)
+ */
+static void disk_trim(t_cache *cache) {
+    DIR *dir = opendir(cache->directory);
+    if (!dir) return;
+
+    t_diskFile *files = NULL;
+    int count = 0, capacity = 0;
+    size_t total = 0;
+    struct dirent *item;
+    char path[CACHE_PATH_MAX];
+    while ((item = readdir(dir)) != NULL) {
+        size_t length = strlen(item->d_name);
+        if (length != 20 || strcmp(item->d_name + 16, ".bmp") != 0) continue;
+        int pathLength = snprintf(path, sizeof(path), "%s/%s", cache->directory, item->d_name);
+        if (pathLength < 0 || pathLength >= (int)sizeof(path)) continue;
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            t_diskFile *grown = (t_diskFile *)realloc(files, capacity * sizeof(t_diskFile));
+            if (!grown) break;
+            files = grown;
+        }
+        memcpy(files[count].name, item->d_name, length + 1);
+        strcpy(path + pathLength - 4, ".key");
+        files[count].size = (size_t)st.st_size + disk_fileSize(path);
+        files[count].mtime = st.st_mtime;
+        total += files[count].size;
+        count++;
+    }
+    closedir(dir);
+
+    if (total > cache->diskBudget && files) {
+        qsort(files, count, sizeof(t_diskFile), disk_compareAge);
+        for (int i = 0; i < count && total > cache->diskBudget; i++) {
+            int pathLength = snprintf(path, sizeof(path), "%s/%s", cache->directory, files[i].name);
+            if (pathLength < 0 || pathLength >= (int)sizeof(path) || remove(path) != 0) continue;
+            strcpy(path + strlen(path) - 4, ".key");
+            remove(path);
+            total -= files[i].size;
+            cache->stats.diskEvictions++;
+        }
+    }
+    cache->stats.diskBytes = total;
+    free(files);
+}
+
+/**
+ * Écrit un résultat sur disque. Les fichiers sont d'abord écrits sous un
+ * nom temporaire puis renommés, pour qu'un lecteur concurrent ne voie
+ * jamais un fichier partiel.
+ * @param replaced Reçoit la taille des fichiers remplacés (même clé déjà stockée)
+ * @return Taille des fichiers écrits (image + clé), 0 en cas d'échec
+ */
+static size_t disk_store(t_cache *cache, const char *key, uint64_t hash, const t_bmp8 *img8, const t_bmp24 *img24,
+                         unsigned int sequence, size_t *replaced) {
+    char path[CACHE_PATH_MAX], temp[CACHE_PATH_MAX];
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), ".tmp%ld.%u", (long)getpid(), sequence);
+    *replaced = 0;
+
+    if (disk_path(cache, hash, ".key", path) != 0) return 0;
+    int length = snprintf(temp, sizeof(temp), "%s%s", path, suffix);
+    if (length < 0 || length >= (int)sizeof(temp)) return 0;
+    size_t oldKey = disk_fileSize(path);
+    FILE *file = fopen(temp, "wb");
+    if (!file) return 0;
+    size_t keyLength = strlen(key);
+    int written = fwrite(key, 1, keyLength, file) == keyLength;
+    if (fclose(file) != 0 || !written || rename(temp, path) != 0) {
+        remove(temp);
+        return 0;
+    }
+    *replaced += oldKey;
+
+    if (disk_path(cache, hash, ".bmp", path) != 0) return keyLength;
+    length = snprintf(temp, sizeof(temp), "%s%s", path, suffix);
+    if (length < 0 || length >= (int)sizeof(temp)) return keyLength;
+    size_t oldImage = disk_fileSize(path);
+    int saved = img8 ? bmp8_saveImage(temp, (t_bmp8 *)img8) : bmp24_saveImage((t_bmp24 *)img24, temp);
+    struct stat st;
+    if (saved != 0 || stat(temp, &st) != 0 || rename(temp, path) != 0) {
+        remove(temp);
+        return keyLength;
+    }
+    *replaced += oldImage;
+    return keyLength + (size_t)st.st_size;
+}
+
+// --- Interface ---
+
+/**
+ * Recopie un résultat en cache dans l'image du pipeline (mêmes dimensions)
+ * @return 0 si succès, -1 si les dimensions ne correspondent pas
+ */
+static int cache_restore(t_pipeline *p, const t_bmp8 *img8, const t_bmp24 *img24) {
+    if (p->img8) {
+        if (!img8 || img8->width != p->img8->width || img8->height != p->img8->height) return -1;
+        memcpy(p->img8->header, img8->header, sizeof(img8->header));
+        memcpy(p->img8->colorTable, img8->colorTable, sizeof(img8->colorTable));
+        memcpy(p->img8->data, img8->data, img8->dataSize);
+    } else {
+        if (!img24 || img24->width != p->img24->width || img24->height != p->img24->height) return -1;
+        p->img24->header = img24->header;
+        p->img24->header_info = img24->header_info;
+        for (int y = 0; y < img24->height; y++) {
+            memcpy(p->img24->data[y], img24->data[y], img24->width * sizeof(t_pixel));
+        }
+    }
+    return 0;
+}
+
+/**
+ * Exécute un pipeline à travers le cache
+ * @param cache Cache (NULL : exécution directe)
+ * @param p Pipeline à exécuter
+ * @return 1 si le résultat provient du cache, 0 s'il a été calculé
+ */
+int cache_execute(t_cache *cache, t_pipeline *p) {
+    if (!p) return 0;
+    if (!cache || p->count == 0) {
+        pipeline_execute(p);
+        return 0;
+    }
+    PROFILE_BEGIN(cache_execute);
+
+    // Clé : empreinte du contenu + chaîne d'opérations
+    char *ops = pipeline_describe(p);
+    uint64_t content = p->img8 ? cache_hash8(p->img8) : cache_hash24(p->img24);
+    char *key = ops ? (char *)malloc(strlen(ops) + 18) : NULL;
+    if (!key) {
+        free(ops);
+        pipeline_execute(p);
+        PROFILE_END(cache_execute, 0);
+        return 0;
+    }
+    sprintf(key, "%016llx|%s", (unsigned long long)content, ops);
+    free(ops);
+    uint64_t hash = cache_hashKey(key);
+
+    // 1. Mémoire
+    pthread_mutex_lock(&cache->lock);
+    t_cacheEntry *entry = memory_find(cache, key, hash);
+    if (entry && cache_restore(p, entry->img8, entry->img24) == 0) {
+        lru_unlink(cache, entry);
+        lru_pushFront(cache, entry);
+        cache->stats.memoryHits++;
+        pthread_mutex_unlock(&cache->lock);
+        pipeline_clear(p);
+        free(key);
+        PROFILE_END(cache_execute, 0);
+        return 1;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    // 2. Disque
+    t_bmp8 *img8 = NULL;
+    t_bmp24 *img24 = NULL;
+    if (cache->directory && disk_load(cache, key, hash, p->img24 != NULL, &img8, &img24) == 0) {
+        if (cache_restore(p, img8, img24) == 0) {
+            pthread_mutex_lock(&cache->lock);
+            cache->stats.diskHits++;
+            memory_insert(cache, key, hash, img8, img24);
+            pthread_mutex_unlock(&cache->lock);
+            pipeline_clear(p);
+            free(key);
+            PROFILE_END(cache_execute, 0);
+            return 1;
+        }
+        bmp8_free(img8);
+        bmp24_free(img24);
+    }
+
+    // 3. Calcul puis mémorisation
+    pipeline_execute(p);
+    img8 = p->img8 ? bmp8_copy(p->img8) : NULL;
+    img24 = p->img24 ? bmp24_copy(p->img24) : NULL;
+
+    pthread_mutex_lock(&cache->lock);
+    cache->stats.misses++;
+    unsigned int sequence = (unsigned int)(cache->stats.misses);
+    pthread_mutex_unlock(&cache->lock);
+
+    size_t stored = 0, replaced = 0;
+    if (cache->directory && (img8 || img24)) {
+        stored = disk_store(cache, key, hash, img8, img24, sequence, &replaced);
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    if (img8 || img24) memory_insert(cache, key, hash, img8, img24);
+    cache->stats.diskBytes -= (replaced < cache->stats.diskBytes) ? replaced : cache->stats.diskBytes;
+    cache->stats.diskBytes += stored;
+    if (cache->stats.diskBytes > cache->diskBudget) disk_trim(cache);
+    pthread_mutex_unlock(&cache->lock);
+
+    free(key);
+    PROFILE_END(cache_execute, p->img8 ? p->img8->dataSize : (size_t)p->img24->width * p->img24->height);
+    return 0;
+}
+
+/**
+ * Copie les compteurs du cache
+ */
+void cache_getStats(t_cache *cache, t_cacheStats *stats) {
+    if (!cache || !stats) return;
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Affiche les compteurs du cache
+ */
+void cache_printStats(t_cache *cache) {
+    t_cacheStats stats;
+    if (!cache) return;
+    cache_getStats(cache, &stats);
+    long long lookups = stats.memoryHits + stats.diskHits + stats.misses;
+    printf("\n--- Cache ---\n");
+    printf("Succes memoire : %lld, succes disque : %lld, echecs : %lld", stats.memoryHits, stats.diskHits, stats.misses);
+    if (lookups) printf(" (taux de succes %.1f %%)", 100.0 * (stats.memoryHits + stats.diskHits) / lookups);
+    printf("\n");
+    printf("Evictions memoire : %lld, evictions disque : %lld\n", stats.evictions, stats.diskEvictions);
+    printf("Memoire : %d entrees, %zu / %zu octets\n", stats.entries, stats.memoryBytes, cache->memoryBudget);
+    if (cache->directory) printf("Disque : %zu / %zu octets (%s)\n", stats.diskBytes, cache->diskBudget, cache->directory);
+}
@@ -0,0 +1,68 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "pipeline.h"
+
+// Cache des résultats de traitement, placé devant pipeline_execute. La clé
+// associe une empreinte du contenu de l'image (dimensions, palette, pixels)
+// à l'encodage canonique de la chaîne d'opérations (pipeline_describe).
+// Deux niveaux : une LRU en mémoire bornée en octets, puis un répertoire
+// sur disque (un fichier BMP par résultat) borné lui aussi, les fichiers
+// les moins récemment utilisés étant supprimés en premier.
+
+#define CACHE_BUCKETS 256
+
+typedef struct t_cacheEntry {
+    char *key;
+    uint64_t hash;
+    t_bmp8 *img8;
+    t_bmp24 *img24;
+    size_t bytes;
+    struct t_cacheEntry *prev;   // LRU : du plus récent (head) au plus ancien (tail)
+    struct t_cacheEntry *next;
+    struct t_cacheEntry *chain;  // alvéole de la table de hachage
+} t_cacheEntry;
+
+typedef struct {
+    long long memoryHits;
+    long long diskHits;
+    long long misses;
+    long long evictions;      // entrées retirées de la mémoire
+    long long diskEvictions;  // fichiers supprimés du répertoire
+    size_t memoryBytes;
+    size_t diskBytes;
+    int entries;
+} t_cacheStats;
+
+typedef struct {
+    pthread_mutex_t lock;
+    t_cacheEntry *buckets[CACHE_BUCKETS];
+    t_cacheEntry *head;
+    t_cacheEntry *tail;
+    size_t memoryBudget;
+    char *directory;          // NULL : pas de niveau disque
+    size_t diskBudget;
+    t_cacheStats stats;
+} t_cache;
+
+// directory peut être NULL (cache mémoire seul) ; il est créé si besoin
+t_cache *cache_create(size_t memoryBudget, const char *directory, size_t diskBudget);
+void cache_free(t_cache *cache);
+
+// Empreinte rapide du contenu d'une image
+uint64_t cache_hash8(const t_bmp8 *img);
+uint64_t cache_hash24(const t_bmp24 *img);
+
+// Équivalent de pipeline_execute : si le résultat est en cache, l'image du
+// pipeline est remplacée par la copie en cache et les opérations sont
+// abandonnées ; sinon le pipeline est exécuté et son résultat mémorisé.
+// Retourne 1 en cas de succès du cache, 0 sinon.
+int cache_execute(t_cache *cache, t_pipeline *p);
+
+void cache_getStats(t_cache *cache, t_cacheStats *stats);
+void cache_printStats(t_cache *cache);
+
+#endif // CACHE_H
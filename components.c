@@ -0,0 +1,332 @@
+#include "components.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bandes par thread : assez pour équilibrer la charge, peu de jointures
+#define COMPONENTS_STRIPS_PER_THREAD 4
+
+// Mesures cumulées d'une étiquette provisoire
+typedef struct {
+    uint64_t area;
+    uint64_t sumX;
+    uint64_t sumY;
+    int minX, minY;
+    int maxX, maxY;
+} t_blob;
+
+// Bande de lignes [rowBegin, rowEnd) (de haut en bas) et ses étiquettes
+// provisoires 1..count (0 = fond)
+typedef struct {
+    int rowBegin;
+    int rowEnd;
+    uint32_t *parent;
+    t_blob *blobs;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *rows;         // 3 lignes de width + 2 étiquettes, bords à 0
+    uint32_t *firstRow;     // étiquettes de la première ligne
+    uint32_t *lastRow;      // étiquettes de la dernière ligne
+    int failed;
+} t_strip;
+
+typedef struct {
+    const t_bmp8 *img;
+    t_connectivity connectivity;
+    t_strip *strips;
+} t_labelJob;
+
+// Racine de x, avec compression de chemin par division
+static uint32_t components_find(uint32_t *parent, uint32_t x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// Réunit les ensembles de a et b ; la racine est toujours la plus petite
+// étiquette, c'est-à-dire la première rencontrée dans l'ordre de parcours
+static uint32_t components_union(uint32_t *parent, uint32_t a, uint32_t b) {
+    a = components_find(parent, a);
+    b = components_find(parent, b);
+    if (a < b) {
+        parent[b] = a;
+        return a;
+    }
+    parent[a] = b;
+    return b;
+}
+
+static uint32_t components_newLabel(t_strip *strip) {
+    if (strip->count + 1 >= strip->capacity) {
+        uint32_t capacity = strip->capacity * 2;
+        uint32_t *parent = (uint32_t *)realloc(strip->parent, (size_t)capacity * sizeof(uint32_t));
+        if (!parent) return 0;
+        strip->parent = parent;
+        t_blob *blobs = (t_blob *)realloc(strip->blobs, (size_t)capacity * sizeof(t_blob));
+        if (!blobs) return 0;
+        strip->blobs = blobs;
+        strip->capacity = capacity;
+    }
+    uint32_t label = ++strip->count;
+    strip->parent[label] = label;
+    strip->blobs[label] = (t_blob){0, 0, 0, INT32_MAX, INT32_MAX, -1, -1};
+    return label;
+}
+
+static void components_addPixel(t_blob *blob, int x, int y) {
+    blob->area++;
+    blob->sumX += (uint64_t)x;
+    blob->sumY += (uint64_t)y;
+    if (x < blob->minX) blob->minX = x;
+    if (x > blob->maxX) blob->maxX = x;
+    if (y < blob->minY) blob->minY = y;
+    if (y > blob->maxY) blob->maxY = y;
+}
+
+/**
+ * Étiquette une bande en un balayage : chaque pixel du premier plan prend
+ * l'étiquette de ses voisins déjà vus (ligne précédente, pixel de gauche),
+ * dont les ensembles sont réunis, ou une nouvelle étiquette
+ */
+static void components_labelStrip(const t_labelJob *job, t_strip *strip) {
+    const t_bmp8 *img = job->img;
+    int width = (int)img->width;
+    size_t rowSize = (size_t)width + 2;
+
+    strip->capacity = 1024;
+    strip->parent = (uint32_t *)malloc(strip->capacity * sizeof(uint32_t));
+    strip->blobs = (t_blob *)malloc(strip->capacity * sizeof(t_blob));
+    strip->rows = (uint32_t *)calloc(3 * rowSize, sizeof(uint32_t));
+    if (!strip->parent || !strip->blobs || !strip->rows) {
+        strip->failed = 1;
+        return;
+    }
+    strip->parent[0] = 0;
+
+    // Indice x + 1 pour le pixel x : les voisins hors de l'image valent 0
+    uint32_t *previous = strip->rows;
+    uint32_t *current = strip->rows + rowSize;
+    strip->firstRow = strip->rows + 2 * rowSize;
+
+    for (int y = strip->rowBegin; y < strip->rowEnd; y++) {
+        const unsigned char *pixels = img->data + (size_t)(img->height - 1 - y) * width;
+        for (int x = 0; x < width; x++) {
+            uint32_t label = 0;
+            if (pixels[x]) {
+                uint32_t up = previous[x + 1];
+                uint32_t left = current[x];
+                if (job->connectivity == COMPONENTS_8) {
+                    // Le voisin du dessus touche les trois autres : s'il est
+                    // au premier plan, ils sont déjà dans son ensemble
+                    if (up) {
+                        label = up;
+                    } else {
+                        uint32_t before = left ? left : previous[x];
+                        uint32_t after = previous[x + 2];
+                        if (before && after) label = components_union(strip->parent, before, after);
+                        else label = before ? before : after;
+                    }
+                } else {
+                    if (up && left && up != left) label = components_union(strip->parent, up, left);
+                    else label = up ? up : left;
+                }
+                if (!label) {
+                    label = components_newLabel(strip);
+                    if (!label) {
+                        strip->failed = 1;
+                        return;
+                    }
+                }
+                components_addPixel(&strip->blobs[label], x, y);
+            }
+            current[x + 1] = label;
+        }
+        if (y == strip->rowBegin) memcpy(strip->firstRow, current, rowSize * sizeof(uint32_t));
+        uint32_t *swap = previous;
+        previous = current;
+        current = swap;
+    }
+    strip->lastRow = previous;
+}
+
+static void components_labelStrips(void *ctx, int begin, int end) {
+    t_labelJob *job = (t_labelJob *)ctx;
+    for (int s = begin; s < end; s++) {
+        components_labelStrip(job, &job->strips[s]);
+    }
+}
+
+/**
+ * Raccorde les bandes : étiquettes globales (étiquette locale + décalage
+ * de la bande), union de part et d'autre des jointures, puis mesures
+ * cumulées par racine
+ */
+static t_components *components_merge(const t_labelJob *job, int stripCount) {
+    int width = (int)job->img->width;
+    uint32_t *offsets = (uint32_t *)malloc((size_t)stripCount * sizeof(uint32_t));
+    if (!offsets) return NULL;
+    uint32_t total = 0;
+    for (int s = 0; s < stripCount; s++) {
+        offsets[s] = total;
+        total += job->strips[s].count;
+    }
+
+    uint32_t *parent = (uint32_t *)malloc(((size_t)total + 1) * sizeof(uint32_t));
+    uint32_t *index = (uint32_t *)malloc(((size_t)total + 1) * sizeof(uint32_t));
+    t_components *result = (t_components *)calloc(1, sizeof(t_components));
+    if (!parent || !index || !result) {
+        free(offsets);
+        free(parent);
+        free(index);
+        free(result);
+        return NULL;
+    }
+    PROFILE_ALLOC(2 * ((size_t)total + 1) * sizeof(uint32_t));
+
+    parent[0] = 0;
+    for (int s = 0; s < stripCount; s++) {
+        const t_strip *strip = &job->strips[s];
+        for (uint32_t l = 1; l <= strip->count; l++) {
+            parent[l + offsets[s]] = strip->parent[l] + offsets[s];
+        }
+    }
+
+    for (int s = 1; s < stripCount; s++) {
+        const uint32_t *above = job->strips[s - 1].lastRow;
+        const uint32_t *below = job->strips[s].firstRow;
+        uint32_t aboveOffset = offsets[s - 1];
+        uint32_t belowOffset = offsets[s];
+        for (int x = 1; x <= width; x++) {
+            if (!below[x]) continue;
+            uint32_t label = below[x] + belowOffset;
+            if (above[x]) components_union(parent, above[x] + aboveOffset, label);
+            if (job->connectivity == COMPONENTS_8) {
+                if (above[x - 1]) components_union(parent, above[x - 1] + aboveOffset, label);
+                if (above[x + 1]) components_union(parent, above[x + 1] + aboveOffset, label);
+            }
+        }
+    }
+
+    // Les racines étant les plus petites étiquettes, celle d'une étiquette
+    // est toujours numérotée avant elle
+    uint32_t count = 0;
+    for (uint32_t l = 1; l <= total; l++) {
+        uint32_t root = components_find(parent, l);
+        index[l] = (root == l) ? count++ : index[root];
+    }
+    free(parent);
+
+    t_blob *sums = (t_blob *)malloc(((size_t)count + 1) * sizeof(t_blob));
+    result->items = (t_component *)malloc(((size_t)count + 1) * sizeof(t_component));
+    if (!sums || !result->items) {
+        free(sums);
+        free(offsets);
+        free(index);
+        components_free(result);
+        return NULL;
+    }
+    for (uint32_t c = 0; c < count; c++) {
+        sums[c] = (t_blob){0, 0, 0, INT32_MAX, INT32_MAX, -1, -1};
+    }
+    for (int s = 0; s < stripCount; s++) {
+        const t_strip *strip = &job->strips[s];
+        for (uint32_t l = 1; l <= strip->count; l++) {
+            const t_blob *blob = &strip->blobs[l];
+            t_blob *sum = &sums[index[l + offsets[s]]];
+            sum->area += blob->area;
+            sum->sumX += blob->sumX;
+            sum->sumY += blob->sumY;
+            if (blob->minX < sum->minX) sum->minX = blob->minX;
+            if (blob->minY < sum->minY) sum->minY = blob->minY;
+            if (blob->maxX > sum->maxX) sum->maxX = blob->maxX;
+            if (blob->maxY > sum->maxY) sum->maxY = blob->maxY;
+        }
+    }
+    for (uint32_t c = 0; c < count; c++) {
+        const t_blob *sum = &sums[c];
+        result->items[c] = (t_component){
+            sum->area, sum->minX, sum->minY, sum->maxX, sum->maxY,
+            (double)sum->sumX / (double)sum->area, (double)sum->sumY / (double)sum->area
+        };
+    }
+    result->count = (int)count;
+
+    free(sums);
+    free(offsets);
+    free(index);
+    return result;
+}
+
+/**
+ * Composantes connexes des pixels non nuls (après report de la palette)
+ * @param img Image binarisée
+ * @param connectivity COMPONENTS_4 ou COMPONENTS_8
+ * @return Composantes et leurs mesures, NULL en cas d'erreur
+ */
+t_components *components_label(t_bmp8 *img, t_connectivity connectivity) {
+    if (!img || !img->data || img->width == 0 || img->height == 0) return NULL;
+    if (connectivity != COMPONENTS_4 && connectivity != COMPONENTS_8) {
+        printf("Erreur : Connexite invalide (%d), 4 ou 8 attendu\n", (int)connectivity);
+        return NULL;
+    }
+    bmp8_applyPalette(img);
+    PROFILE_BEGIN(components_label);
+
+    int stripCount = threadpool_threadCount() * COMPONENTS_STRIPS_PER_THREAD;
+    if (stripCount > (int)img->height) stripCount = (int)img->height;
+    t_strip *strips = (t_strip *)calloc((size_t)stripCount, sizeof(t_strip));
+    if (!strips) {
+        printf("Erreur : Allocation memoire echouee pour l'etiquetage\n");
+        PROFILE_END(components_label, 0);
+        return NULL;
+    }
+    for (int s = 0; s < stripCount; s++) {
+        strips[s].rowBegin = (int)((uint64_t)img->height * s / stripCount);
+        strips[s].rowEnd = (int)((uint64_t)img->height * (s + 1) / stripCount);
+    }
+
+    t_labelJob job = {img, connectivity, strips};
+    threadpool_parallelFor(0, stripCount, 1, components_labelStrips, &job);
+
+    t_components *result = NULL;
+    int failed = 0;
+    for (int s = 0; s < stripCount; s++) failed |= strips[s].failed;
+    if (!failed) result = components_merge(&job, stripCount);
+    if (!result) printf("Erreur : Allocation memoire echouee pour l'etiquetage\n");
+
+    for (int s = 0; s < stripCount; s++) {
+        free(strips[s].parent);
+        free(strips[s].blobs);
+        free(strips[s].rows);
+    }
+    free(strips);
+    PROFILE_END(components_label, img->dataSize);
+    return result;
+}
+
+void components_free(t_components *components) {
+    if (!components) return;
+    free(components->items);
+    free(components);
+}
+
+/**
+ * Affiche le nombre de composantes et les mesures des premières
+ * @param components Résultat de components_label
+ * @param limit Nombre maximal de composantes détaillées
+ */
+void components_print(const t_components *components, int limit) {
+    if (!components) return;
+    printf("\n--- Composantes connexes ---\n");
+    printf("Nombre : %d\n", components->count);
+    for (int i = 0; i < components->count && i < limit; i++) {
+        const t_component *c = &components->items[i];
+        printf("%d : aire %llu, boite (%d, %d) - (%d, %d), centre (%.1f, %.1f)\n", i + 1,
+               (unsigned long long)c->area, c->minX, c->minY, c->maxX, c->maxY, c->centroidX, c->centroidY);
+    }
+    if (components->count > limit) printf("... (%d autres)\n", components->count - limit);
+}
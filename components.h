@@ -0,0 +1,46 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <stdint.h>
+#include "bmp8.h"
+
+// Étiquetage en composantes connexes d'une image 8 bits binarisée (par
+// exemple après bmp8_threshold) : un pixel non nul appartient au premier
+// plan. L'image est découpée en bandes horizontales étiquetées en
+// parallèle (union-find, un seul balayage par bande) ; les bandes sont
+// ensuite raccordées en unissant les étiquettes de part et d'autre de
+// chaque jointure. Seules deux lignes d'étiquettes par bande sont gardées
+// en mémoire, pas d'image d'étiquettes complète.
+//
+// Les composantes sont rangées dans l'ordre de leur premier pixel en
+// parcourant l'image de haut en bas et de gauche à droite, quel que soit
+// le nombre de bandes.
+
+// Voisinage : 4 (côtés) ou 8 (côtés et diagonales)
+typedef enum {
+    COMPONENTS_4 = 4,
+    COMPONENTS_8 = 8
+} t_connectivity;
+
+// Mesures d'une composante (coordonnées de haut en bas, comme t_roi)
+typedef struct {
+    uint64_t area;          // nombre de pixels
+    int minX, minY;         // boîte englobante, bornes incluses
+    int maxX, maxY;
+    double centroidX;       // centre de gravité
+    double centroidY;
+} t_component;
+
+typedef struct {
+    t_component *items;
+    int count;
+} t_components;
+
+// Retourne NULL en cas d'erreur (à libérer avec components_free)
+t_components *components_label(t_bmp8 *img, t_connectivity connectivity);
+void components_free(t_components *components);
+
+// Affiche le nombre de composantes et les limit premières
+void components_print(const t_components *components, int limit);
+
+#endif // COMPONENTS_H
@@ -0,0 +1,257 @@
+#include "fft.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Nombre complexe simple précision
+typedef struct {
+    float re;
+    float im;
+} t_complex;
+
+// Tables précalculées pour une taille de FFT donnée (lecture seule,
+// partagées par toutes les tâches)
+typedef struct {
+    int n;
+    int *bitrev;        // permutation par inversion des bits
+    t_complex *twiddle; // racines n-ièmes de l'unité, n / 2 valeurs
+} t_fftPlan;
+
+static int fft_planInit(t_fftPlan *plan, int n) {
+    plan->n = n;
+    plan->bitrev = (int *)malloc(n * sizeof(int));
+    plan->twiddle = (t_complex *)malloc((n / 2) * sizeof(t_complex));
+    if (!plan->bitrev || !plan->twiddle) return -1;
+
+    int bits = 0;
+    while ((1 << bits) < n) bits++;
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        plan->bitrev[i] = r;
+    }
+    for (int i = 0; i < n / 2; i++) {
+        double angle = -2.0 * M_PI * i / n;
+        plan->twiddle[i].re = (float)cos(angle);
+        plan->twiddle[i].im = (float)sin(angle);
+    }
+    return 0;
+}
+
+static void fft_planFree(t_fftPlan *plan) {
+    free(plan->bitrev);
+    free(plan->twiddle);
+}
+
+/**
+ * FFT radix-2 itérative, sur place
+ * @param plan Tables de la taille n
+ * @param data Tableau de n complexes
+ * @param inverse 1 pour la transformée inverse (non normalisée)
+ */
+static void fft_1d(const t_fftPlan *plan, t_complex *data, int inverse) {
+    int n = plan->n;
+    for (int i = 0; i < n; i++) {
+        int j = plan->bitrev[i];
+        if (j > i) {
+            t_complex tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len / 2;
+        int step = n / len;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half; k++) {
+                t_complex w = plan->twiddle[k * step];
+                if (inverse) w.im = -w.im;
+                t_complex *a = &data[start + k];
+                t_complex *b = &data[start + k + half];
+                float tre = b->re * w.re - b->im * w.im;
+                float tim = b->re * w.im + b->im * w.re;
+                b->re = a->re - tre;
+                b->im = a->im - tim;
+                a->re += tre;
+                a->im += tim;
+            }
+        }
+    }
+}
+
+/**
+ * FFT 2D d'un bloc n x n (lignes puis colonnes)
+ * @param rows Nombre de lignes non nulles en entrée (les autres sont ignorées à l'aller)
+ * @param column Tampon de n complexes pour les passes sur les colonnes
+ */
+static void fft_2d(const t_fftPlan *plan, t_complex *block, int rows, int inverse, t_complex *column) {
+    int n = plan->n;
+    for (int y = 0; y < rows; y++) {
+        fft_1d(plan, block + (size_t)y * n, inverse);
+    }
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) column[y] = block[(size_t)y * n + x];
+        fft_1d(plan, column, inverse);
+        for (int y = 0; y < n; y++) block[(size_t)y * n + x] = column[y];
+    }
+}
+
+// Contexte d'une bande pour les tâches de tuiles
+typedef struct {
+    const unsigned char *plane;
+    int width;
+    int kernelSize;
+    const t_fftPlan *plan;
+    const t_complex *spectrum;
+    float *acc;
+    int accWidth;
+    int block;
+    int y0;
+    int bh;
+    int parity;     // tuiles paires ou impaires
+    t_complex *tiles;   // un tampon de tuile par morceau de la boucle parallèle
+    int grain;          // tuiles par morceau
+} t_fftBand;
+
+/**
+ * Convolue les tuiles [begin, end) de même parité d'une bande. Deux tuiles
+ * de même parité ne se recouvrent pas dans l'accumulateur, elles peuvent
+ * donc être traitées en parallèle sans verrou.
+ */
+static void fft_tilesTask(void *ctx, int begin, int end) {
+    t_fftBand *band = (t_fftBand *)ctx;
+    int n = band->plan->n;
+    int k = band->kernelSize;
+    // Chaque morceau n'est exécuté qu'une fois : son tampon lui est propre
+    t_complex *tile = band->tiles + (size_t)(begin / band->grain) * ((size_t)n * n + n);
+    t_complex *column = tile + (size_t)n * n;
+
+    for (int t = begin; t < end; t++) {
+        int x0 = (2 * t + band->parity) * band->block;
+        int bw = (band->width - x0 < band->block) ? band->width - x0 : band->block;
+
+        // Tuile d'entrée complétée par des zéros
+        memset(tile, 0, (size_t)n * n * sizeof(t_complex));
+        for (int i = 0; i < band->bh; i++) {
+            const unsigned char *src = band->plane + (size_t)(band->y0 + i) * band->width + x0;
+            t_complex *dst = tile + (size_t)i * n;
+            for (int j = 0; j < bw; j++) dst[j].re = src[j];
+        }
+
+        fft_2d(band->plan, tile, band->bh, 0, column);
+        for (size_t i = 0; i < (size_t)n * n; i++) {
+            float re = tile[i].re * band->spectrum[i].re - tile[i].im * band->spectrum[i].im;
+            float im = tile[i].re * band->spectrum[i].im + tile[i].im * band->spectrum[i].re;
+            tile[i].re = re;
+            tile[i].im = im;
+        }
+        fft_2d(band->plan, tile, n, 1, column);
+
+        // Overlap-add : la tuile déborde de kernelSize - 1 sur ses voisines
+        for (int i = 0; i < band->bh + k - 1; i++) {
+            float *dst = band->acc + (size_t)i * band->accWidth + x0;
+            const t_complex *src = tile + (size_t)i * n;
+            for (int j = 0; j < bw + k - 1; j++) dst[j] += src[j].re;
+        }
+    }
+}
+
+/**
+ * Convolution d'un plan 8 bits par FFT (overlap-add par bandes)
+ * @param plane Plan de pixels, modifié sur place
+ * @param width Largeur du plan
+ * @param height Hauteur du plan
+ * @param kernel Noyau de convolution (kernelSize x kernelSize)
+ * @param kernelSize Taille du noyau (impaire)
+ * @return 0 si succès, -1 en cas d'échec d'allocation (plan inchangé)
+ */
+int fft_convolvePlane(unsigned char *plane, int width, int height, float **kernel, int kernelSize) {
+    int offset = kernelSize / 2;
+    if (width <= 2 * offset || height <= 2 * offset) return 0; // aucun pixel interne
+
+    // Taille de FFT : au moins deux fois le noyau pour amortir le recouvrement
+    int n = 64;
+    while (n < 2 * kernelSize) n <<= 1;
+    int block = n - kernelSize + 1;       // taille des tuiles d'entrée
+    int accWidth = width + kernelSize - 1;
+    int accRows = block + kernelSize - 1;
+
+    // Une rangée de tuiles d'une parité est découpée en au plus nThreads
+    // morceaux : tous les tampons sont alloués avant d'écrire dans le plan,
+    // un échec laisse donc le plan inchangé
+    int tilesPerRow = (width + block - 1) / block;
+    int nThreads = threadpool_threadCount();
+    int grain = ((tilesPerRow + 1) / 2 + nThreads - 1) / nThreads;
+    int chunks = ((tilesPerRow + 1) / 2 + grain - 1) / grain;
+
+    t_fftPlan plan;
+    memset(&plan, 0, sizeof(plan));
+    t_complex *spectrum = (t_complex *)calloc((size_t)n * n + n, sizeof(t_complex));
+    t_complex *tiles = (t_complex *)malloc((size_t)chunks * ((size_t)n * n + n) * sizeof(t_complex));
+    float *acc = (float *)calloc((size_t)accRows * accWidth, sizeof(float));
+    if (fft_planInit(&plan, n) != 0 || !spectrum || !tiles || !acc) {
+        printf("Erreur : Allocation memoire echouee pour la convolution FFT.\n");
+        fft_planFree(&plan);
+        free(spectrum);
+        free(tiles);
+        free(acc);
+        return -1;
+    }
+    PROFILE_ALLOC(((size_t)chunks + 1) * ((size_t)n * n + n) * sizeof(t_complex) + (size_t)accRows * accWidth * sizeof(float));
+    PROFILE_BEGIN(fft_convolvePlane);
+
+    // Spectre du noyau retourné (la convolution FFT calcule une convolution
+    // vraie, le chemin direct une corrélation), normalisation incluse
+    float norm = 1.0f / ((float)n * n);
+    for (int ky = 0; ky < kernelSize; ky++) {
+        for (int kx = 0; kx < kernelSize; kx++) {
+            spectrum[(size_t)ky * n + kx].re = kernel[kernelSize - 1 - ky][kernelSize - 1 - kx] * norm;
+        }
+    }
+    fft_2d(&plan, spectrum, kernelSize, 0, spectrum + (size_t)n * n);
+
+    for (int y0 = 0; y0 < height; y0 += block) {
+        int bh = (height - y0 < block) ? height - y0 : block;
+
+        // Tuiles paires puis impaires, chaque groupe en parallèle
+        for (int parity = 0; parity < 2; parity++) {
+            t_fftBand band = {plane, width, kernelSize, &plan, spectrum, acc, accWidth, block, y0, bh, parity, tiles, grain};
+            threadpool_parallelFor(0, (tilesPerRow - parity + 1) / 2, grain, fft_tilesTask, &band);
+        }
+
+        // Les bh premières lignes de l'accumulateur sont complètes : la ligne
+        // i correspond au pixel de sortie y0 + i - offset
+        for (int i = 0; i < bh; i++) {
+            int y = y0 + i - offset;
+            if (y < offset || y >= height - offset) continue;
+            const float *src = acc + (size_t)i * accWidth + offset;
+            unsigned char *dst = plane + (size_t)y * width;
+            for (int x = offset; x < width - offset; x++) {
+                int pixel = (int)roundf(src[x]);
+                if (pixel > 255) pixel = 255;
+                if (pixel < 0) pixel = 0;
+                dst[x] = (unsigned char)pixel;
+            }
+        }
+
+        // Le recouvrement vertical est reporté sur la bande suivante
+        memmove(acc, acc + (size_t)bh * accWidth, (size_t)(kernelSize - 1) * accWidth * sizeof(float));
+        memset(acc + (size_t)(kernelSize - 1) * accWidth, 0, (size_t)(accRows - kernelSize + 1) * accWidth * sizeof(float));
+    }
+
+    fft_planFree(&plan);
+    free(spectrum);
+    free(tiles);
+    free(acc);
+    PROFILE_END(fft_convolvePlane, (size_t)width * height);
+    return 0;
+}
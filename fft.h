@@ -0,0 +1,15 @@
+#ifndef FFT_H
+#define FFT_H
+
+// Taille de noyau à partir de laquelle la convolution passe par la FFT
+// (mesuré sur une image 1024x1024 : les deux chemins sont à égalité vers
+// 9x9, la FFT est déjà 1,6 fois plus rapide en 11x11 et 6 fois en 31x31)
+#define FFT_CROSSOVER_KERNEL_SIZE 11
+
+// Convolution d'un plan 8 bits (width * height octets) par FFT avec
+// découpage overlap-add. Même sémantique que le chemin direct : seuls les
+// pixels internes sont recalculés, les bords restent inchangés. Le
+// résultat diffère du chemin direct d'au plus 1 niveau (arrondi flottant).
+int fft_convolvePlane(unsigned char *plane, int width, int height, float **kernel, int kernelSize);
+
+#endif // FFT_H
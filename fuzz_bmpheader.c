@@ -0,0 +1,95 @@
+// Cible de fuzzing des en-têtes BMP et des chargeurs (option CMake
+// PROJETC_FUZZ). Avec clang, libFuzzer fournit main() :
+//   ./fuzz_bmpheader corpus/
+// Avec un autre compilateur, le pilote autonome ci-dessous rejoue les
+// fichiers passés en argument, ou l'entrée standard (mode AFL) :
+//   ./fuzz_bmpheader crash-1234 ...
+//   afl-fuzz -i corpus -o sorties -- ./fuzz_bmpheader
+#define _GNU_SOURCE
+#include "bmpheader.h"
+#include "bmp8.h"
+#include "bmp24.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define FUZZ_MAX_INPUT (1u << 24)   // au-delà, l'entrée est ignorée
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    // Les chargeurs signalent chaque fichier refusé sur la sortie standard
+    FILE *sink = freopen("/dev/null", "w", stdout);
+    (void)sink;
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size > FUZZ_MAX_INPUT) return 0;
+
+    // 1. Validation en mémoire, sans E/S
+    t_bmpFormat format;
+    if (size >= BMP_HEADER_SIZE) bmpheader_parse(data, size, size, &format);
+
+    // 2. Chargeurs complets, sur un fichier en mémoire nommé par /proc
+    int fd = memfd_create("fuzz_bmpheader", 0);
+    if (fd < 0) return 0;
+    if (write(fd, data, size) != (ssize_t)size) {
+        close(fd);
+        return 0;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+
+    FILE *file = fopen(path, "rb");
+    if (file) {
+        bmpheader_read(file, &format);
+        fclose(file);
+    }
+    bmp8_free(bmp8_loadImage(path));
+    bmp24_free(bmp24_loadImage(path));
+    t_roi roi = {1, 1, 7, 5};
+    bmp8_free(bmp8_loadImageRoi(path, roi));
+    bmp24_free(bmp24_loadImageRoi(path, roi));
+
+    close(fd);
+    return 0;
+}
+
+#ifdef PROJETC_FUZZ_STANDALONE
+// Lit un fichier entier (FUZZ_MAX_INPUT octets au plus)
+static unsigned char *fuzz_readAll(FILE *file, size_t *size) {
+    unsigned char *data = (unsigned char *)malloc(FUZZ_MAX_INPUT);
+    if (!data) return NULL;
+    *size = fread(data, 1, FUZZ_MAX_INPUT, file);
+    return data;
+}
+
+int main(int argc, char *argv[]) {
+    LLVMFuzzerInitialize(&argc, &argv);
+    if (argc < 2) {
+        size_t size;
+        unsigned char *data = fuzz_readAll(stdin, &size);
+        if (!data) return EXIT_FAILURE;
+        LLVMFuzzerTestOneInput(data, size);
+        free(data);
+        return EXIT_SUCCESS;
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (!file) {
+            fprintf(stderr, "Erreur : Impossible d'ouvrir le fichier %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        size_t size;
+        unsigned char *data = fuzz_readAll(file, &size);
+        fclose(file);
+        if (!data) return EXIT_FAILURE;
+        LLVMFuzzerTestOneInput(data, size);
+        free(data);
+    }
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,276 @@
+#include "histogram.h"
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "threadpool.h"
+
+// Taille des blocs traités par tâche pour les parcours linéaires
+#define HISTOGRAM_BLOCK 65536
+
+// Contexte partagé par les tâches CLAHE
+typedef struct {
+    unsigned char *plane;
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    float clipLimit;
+    unsigned char (*luts)[256]; // une table de correspondance par tuile
+    const int *colFirst, *colSecond, *colWeight;
+    const int *rowFirst, *rowSecond, *rowWeight;
+    const int *runEnd;          // fins des suites de colonnes de même paire de tuiles
+    int nRuns;
+    unsigned short *blend;      // tilesX tables mélangées par morceau de lignes
+    int grain;                  // lignes par morceau
+} t_claheJob;
+
+/**
+ * Calcule la table de correspondance d'une tuile : histogramme,
+ * écrêtage à clipLimit fois la moyenne par niveau, redistribution
+ * de l'excédent puis CDF normalisée.
+ */
+static void clahe_tileLut(const t_claheJob *job, int tile, unsigned char lut[256]) {
+    int tx = tile % job->tilesX;
+    int ty = tile / job->tilesX;
+    int x0 = tx * job->width / job->tilesX;
+    int x1 = (tx + 1) * job->width / job->tilesX;
+    int y0 = ty * job->height / job->tilesY;
+    int y1 = (ty + 1) * job->height / job->tilesY;
+    int total = (x1 - x0) * (y1 - y0);
+
+    int histogram[256] = {0};
+    for (int y = y0; y < y1; y++) {
+        const unsigned char *row = job->plane + (size_t)y * job->width;
+        for (int x = x0; x < x1; x++) {
+            histogram[row[x]]++;
+        }
+    }
+
+    // Écrêtage : on limite chaque niveau puis on répartit l'excédent
+    int limit = (int)(job->clipLimit * total / 256.0f);
+    if (limit < 1) limit = 1;
+    int excess = 0;
+    for (int i = 0; i < 256; i++) {
+        if (histogram[i] > limit) {
+            excess += histogram[i] - limit;
+            histogram[i] = limit;
+        }
+    }
+    int bonus = excess / 256;
+    int rest = excess % 256;
+    for (int i = 0; i < 256; i++) {
+        histogram[i] += bonus;
+    }
+    if (rest > 0) {
+        int step = 256 / rest;
+        for (int i = 0; i < 256 && rest > 0; i += step, rest--) {
+            histogram[i]++;
+        }
+    }
+
+    // CDF normalisée sur [0, 255]
+    int cdf = 0;
+    for (int i = 0; i < 256; i++) {
+        cdf += histogram[i];
+        lut[i] = (unsigned char)(((long long)cdf * 255 + total / 2) / total);
+    }
+}
+
+static void clahe_tilesTask(void *ctx, int begin, int end) {
+    t_claheJob *job = (t_claheJob *)ctx;
+    PROFILE_BEGIN(clahe_tiles);
+    for (int t = begin; t < end; t++) {
+        clahe_tileLut(job, t, job->luts[t]);
+    }
+    PROFILE_END(clahe_tiles, (long long)(end - begin) * job->width * job->height / (job->tilesX * job->tilesY));
+}
+
+/**
+ * Interpolation bilinéaire entre les tables des 4 tuiles voisines, par lignes.
+ * Le mélange vertical ne dépend que de la ligne : il est fait une fois par
+ * ligne sur les tables entières (boucles contiguës, vectorisées), ce qui
+ * laisse deux lectures de table par pixel au lieu de quatre. Les colonnes
+ * sont parcourues par suites qui partagent la même paire de tuiles ; hors
+ * des zones de transition, une seule lecture suffit. Le résultat est
+ * identique à l'interpolation directe (même somme entière).
+ */
+static void clahe_remapTask(void *ctx, int begin, int end) {
+    t_claheJob *job = (t_claheJob *)ctx;
+    unsigned short (*blend)[256] = (unsigned short (*)[256])job->blend + (size_t)(begin / job->grain) * job->tilesX;
+    for (int y = begin; y < end; y++) {
+        const unsigned char (*top)[256] = job->luts + job->rowFirst[y] * job->tilesX;
+        const unsigned char (*bottom)[256] = job->luts + job->rowSecond[y] * job->tilesX;
+        unsigned short wy = (unsigned short)job->rowWeight[y];
+        unsigned short wTop = (unsigned short)(256 - wy);
+        for (int t = 0; t < job->tilesX; t++) {
+            unsigned short *restrict mixed = blend[t];
+            for (int v = 0; v < 256; v++) {
+                mixed[v] = (unsigned short)(top[t][v] * wTop + bottom[t][v] * wy);  // <= 255 * 256
+            }
+        }
+
+        unsigned char *row = job->plane + (size_t)y * job->width;
+        int x = 0;
+        for (int r = 0; r < job->nRuns; r++) {
+            int last = job->runEnd[r];
+            const unsigned short *left = blend[job->colFirst[x]];
+            const unsigned short *right = blend[job->colSecond[x]];
+            if (left == right) {
+                for (; x < last; x++) {
+                    row[x] = (unsigned char)((left[row[x]] * 256u + (1u << 15)) >> 16);
+                }
+            } else {
+                const int *weight = job->colWeight;
+                for (; x < last; x++) {
+                    unsigned int v = row[x];
+                    unsigned int wx = (unsigned int)weight[x];
+                    row[x] = (unsigned char)((left[v] * (256u - wx) + right[v] * wx + (1u << 15)) >> 16);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Prépare, pour chaque colonne (ou ligne), les deux tuiles voisines
+ * et le poids d'interpolation (sur 256) entre leurs centres
+ */
+static void clahe_axisWeights(int size, int tiles, int *first, int *second, int *weight) {
+    // Les centres sont manipulés au double (début + fin - 1) pour rester en entiers
+    int t = 0;
+    for (int p = 0; p < size; p++) {
+        int q = 2 * p;
+        while (t < tiles - 1 && q >= (t + 1) * size / tiles + (t + 2) * size / tiles - 1) t++;
+        int c0 = t * size / tiles + (t + 1) * size / tiles - 1;
+        if (q <= c0 || t == tiles - 1) {
+            first[p] = t;
+            second[p] = t;
+            weight[p] = 0;
+        } else {
+            int c1 = (t + 1) * size / tiles + (t + 2) * size / tiles - 1;
+            first[p] = t;
+            second[p] = t + 1;
+            weight[p] = (q - c0) * 256 / (c1 - c0);
+        }
+    }
+}
+
+/**
+ * Égalisation adaptative d'histogramme à contraste limité (CLAHE)
+ * @param plane Plan de niveaux de gris (modifié sur place)
+ * @param width Largeur du plan
+ * @param height Hauteur du plan
+ * @param tilesX Nombre de tuiles horizontales
+ * @param tilesY Nombre de tuiles verticales
+ * @param clipLimit Limite d'écrêtage (multiple de la moyenne par niveau)
+ */
+void histogram_clahe(unsigned char *plane, int width, int height, int tilesX, int tilesY, float clipLimit) {
+    if (!plane || width <= 0 || height <= 0) return;
+    if (tilesX < 1) tilesX = 1;
+    if (tilesY < 1) tilesY = 1;
+    if (tilesX > width) tilesX = width;
+    if (tilesY > height) tilesY = height;
+
+    int nTiles = tilesX * tilesY;
+    int chunks = threadpool_threadCount();
+    unsigned char (*luts)[256] = malloc(nTiles * sizeof(*luts));
+    int *colFirst = (int *)malloc(width * 4 * sizeof(int));
+    int *rowFirst = (int *)malloc(height * 3 * sizeof(int));
+    unsigned short *blend = (unsigned short *)malloc((size_t)chunks * tilesX * 256 * sizeof(unsigned short));
+    if (!luts || !colFirst || !rowFirst || !blend) {
+        printf("Erreur : Allocation memoire echouee pour CLAHE.\n");
+        free(luts);
+        free(colFirst);
+        free(rowFirst);
+        free(blend);
+        return;
+    }
+
+    int *colSecond = colFirst + width, *colWeight = colFirst + 2 * width, *runEnd = colFirst + 3 * width;
+    int *rowSecond = rowFirst + height, *rowWeight = rowFirst + 2 * height;
+    clahe_axisWeights(width, tilesX, colFirst, colSecond, colWeight);
+    clahe_axisWeights(height, tilesY, rowFirst, rowSecond, rowWeight);
+
+    // Suites de colonnes qui partagent la même paire de tuiles
+    int nRuns = 0;
+    for (int x = 1; x <= width; x++) {
+        if (x == width || colFirst[x] != colFirst[x - 1] || colSecond[x] != colSecond[x - 1]) runEnd[nRuns++] = x;
+    }
+
+    t_claheJob job = {plane, width, height, tilesX, tilesY, clipLimit, luts,
+                      colFirst, colSecond, colWeight, rowFirst, rowSecond, rowWeight,
+                      runEnd, nRuns, blend, (height + chunks - 1) / chunks};
+
+    // Étape 1 : tables des tuiles, une tâche par tuile (coût inégal selon le contenu)
+    threadpool_parallelFor(0, nTiles, 1, clahe_tilesTask, &job);
+
+    // Étape 2 : interpolation et remplacement, en une passe par bandes de
+    // lignes ; au plus chunks morceaux, chacun avec ses tables mélangées
+    threadpool_parallelFor(0, height, job.grain, clahe_remapTask, &job);
+
+    free(luts);
+    free(colFirst);
+    free(rowFirst);
+    free(blend);
+}
+
+// Contexte des parcours linéaires (histogramme, application d'une table)
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    int *histogram;
+    const unsigned char *lut;
+    pthread_mutex_t lock;
+} t_linearJob;
+
+static void histogram_computeTask(void *ctx, int begin, int end) {
+    t_linearJob *job = (t_linearJob *)ctx;
+    int local[256] = {0};
+    size_t first = (size_t)begin * HISTOGRAM_BLOCK;
+    size_t last = (size_t)end * HISTOGRAM_BLOCK;
+    if (last > job->size) last = job->size;
+    for (size_t i = first; i < last; i++) {
+        local[job->data[i]]++;
+    }
+    pthread_mutex_lock(&job->lock);
+    for (int i = 0; i < 256; i++) {
+        job->histogram[i] += local[i];
+    }
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void histogram_applyTask(void *ctx, int begin, int end) {
+    t_linearJob *job = (t_linearJob *)ctx;
+    size_t first = (size_t)begin * HISTOGRAM_BLOCK;
+    size_t last = (size_t)end * HISTOGRAM_BLOCK;
+    if (last > job->size) last = job->size;
+    for (size_t i = first; i < last; i++) {
+        job->data[i] = job->lut[job->data[i]];
+    }
+}
+
+/**
+ * Histogramme des niveaux d'un tableau d'octets, calculé en parallèle
+ * @param data Données à analyser
+ * @param size Nombre d'octets
+ * @param histogram Histogramme de sortie (256 entrées, remis à zéro)
+ */
+void histogram_compute(const unsigned char *data, size_t size, int histogram[256]) {
+    for (int i = 0; i < 256; i++) histogram[i] = 0;
+    t_linearJob job = {(unsigned char *)data, size, histogram, NULL, PTHREAD_MUTEX_INITIALIZER};
+    threadpool_parallelFor(0, (int)((size + HISTOGRAM_BLOCK - 1) / HISTOGRAM_BLOCK), 0, histogram_computeTask, &job);
+    pthread_mutex_destroy(&job.lock);
+}
+
+/**
+ * Remplace chaque octet par son image dans une table, en parallèle
+ * @param data Données à transformer
+ * @param size Nombre d'octets
+ * @param lut Table de correspondance (256 entrées)
+ */
+void histogram_applyLut(unsigned char *data, size_t size, const unsigned char lut[256]) {
+    t_linearJob job = {data, size, NULL, lut, PTHREAD_MUTEX_INITIALIZER};
+    threadpool_parallelFor(0, (int)((size + HISTOGRAM_BLOCK - 1) / HISTOGRAM_BLOCK), 0, histogram_applyTask, &job);
+    pthread_mutex_destroy(&job.lock);
+}
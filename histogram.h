@@ -0,0 +1,18 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+
+// Paramètres par défaut de l'égalisation adaptative (CLAHE)
+#define CLAHE_DEFAULT_TILES 8
+#define CLAHE_DEFAULT_CLIP 2.0f
+
+// Égalisation adaptative à contraste limité sur un plan de niveaux de gris
+// (width * height octets, ligne par ligne)
+void histogram_clahe(unsigned char *plane, int width, int height, int tilesX, int tilesY, float clipLimit);
+
+// Parcours linéaires parallélisés, partagés par les égalisations 8 et 24 bits
+void histogram_compute(const unsigned char *data, size_t size, int histogram[256]);
+void histogram_applyLut(unsigned char *data, size_t size, const unsigned char lut[256]);
+
+#endif // HISTOGRAM_H
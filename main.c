@@ -2,6 +2,14 @@
 #include <string.h>
 #include "bmp8.h"
 #include "bmp24.h"
+#include "histogram.h"
+#include "quantize.h"
+#include "morpho.h"
+#include "components.h"
+#include "server.h"
+#include "sequence.h"
+#include "bench.h"
+#include "profile.h"
 
 
 // --- MENUS ---
@@ -27,7 +35,11 @@ void afficherMenuFiltres8bits() {
     printf("7. Relief\n");
     printf("8. Nettete\n");
     printf("9. Egalisation histogramme\n");
-    printf("10. Retour\n");
+    printf("10. Egalisation adaptative (CLAHE)\n");
+    printf("11. Convertir en 24 bits\n");
+    printf("12. Morphologie\n");
+    printf("13. Composantes connexes\n");
+    printf("14. Retour\n");
     printf(">>> ");
 }
 
@@ -40,7 +52,10 @@ void afficherMenuFiltres24bits() {
     printf("3. Modifier la luminosite\n");
     printf("4. Filtres convolution\n");
     printf("5. Egalisation histogramme\n");
-    printf("6. Retour\n");
+    printf("6. Egalisation adaptative (CLAHE)\n");
+    printf("7. Convertir en 8 bits (niveaux de gris)\n");
+    printf("8. Convertir en 8 bits (256 couleurs)\n");
+    printf("9. Retour\n");
     printf(">>> ");
 }
 
@@ -76,9 +91,64 @@ void libererKernel(float **kernel, int size) {
     free(kernel);
 }
 
+// --- PROFIL ---
+
+// Écrit le profil en fin de programme, quel que soit le mode (sans effet
+// sans PROJETC_PROFILING) et retourne status
+int terminer(int status) {
+#ifdef PROJETC_PROFILING
+    profile_dumpJson(PROFILE_JSON_FILE);
+    profile_dumpChromeTrace(PROFILE_TRACE_FILE);
+    printf("Profil ecrit dans %s et %s\n", PROFILE_JSON_FILE, PROFILE_TRACE_FILE);
+#endif
+    return status;
+}
+
 // --- MAIN ---
 
-int main(void) {
+int main(int argc, char *argv[]) {
+    // Modes non interactifs : serveur résident et client associé
+    if (argc == 3 && strcmp(argv[1], "--serve") == 0) {
+        return terminer(server_run(argv[2]) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if (argc >= 4 && strcmp(argv[1], "--send") == 0) {
+        char request[SERVER_LINE_MAX] = "";
+        for (int i = 3; i < argc; i++) {
+            if (i > 3) strncat(request, " ", sizeof(request) - strlen(request) - 1);
+            strncat(request, argv[i], sizeof(request) - strlen(request) - 1);
+        }
+        return server_send(argv[2], request) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 4 && argc <= 6 && strcmp(argv[1], "--sequence") == 0) {
+        // --sequence <entree_%04d.bmp> <sortie_%04d.bmp | -> [operations | -] [temporel | -]
+        t_sequenceOptions options;
+        sequence_defaultOptions(&options);
+        options.inputPattern = argv[2];
+        options.outputPattern = strcmp(argv[3], "-") == 0 ? NULL : argv[3];
+        options.ops = argc >= 5 ? argv[4] : NULL;
+        if (argc == 6 && sequence_parseMode(&options, argv[5]) != 0) {
+            printf("Erreur : Operation temporelle invalide : %s (average[:alpha], diff, background[:alpha[:seuil]])\n", argv[5]);
+            return EXIT_FAILURE;
+        }
+        return terminer(sequence_run(&options, NULL) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if ((argc == 2 || argc == 4) && strcmp(argv[1], "--bench") == 0) {
+        // --bench [largeur hauteur]
+        int width = argc == 4 ? atoi(argv[2]) : BENCH_DEFAULT_WIDTH;
+        int height = argc == 4 ? atoi(argv[3]) : BENCH_DEFAULT_HEIGHT;
+        if (width < 32 || height < 32) {
+            printf("Erreur : Dimensions de mesure invalides (32x32 minimum)\n");
+            return EXIT_FAILURE;
+        }
+        return terminer(bench_run(width, height) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if (argc > 1) {
+        printf("Usage : %s [--serve <socket> | --send <socket> <requete> |\n"
+               "          --sequence <entree_%%04d.bmp> <sortie_%%04d.bmp|-> [operations|-] [temporel|-] |\n"
+               "          --bench [largeur hauteur]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
     t_bmp8 *image8 = NULL;
     t_bmp24 *image24 = NULL;
     int choice;
@@ -117,11 +187,9 @@ int main(void) {
                 printf("Entrez le nom du fichier de sortie (mettre '.bmp' a la fin du nom) : ");
                 scanf("%s", filename);
                 if (image8) {
-                    bmp8_saveImage(filename, image8);
-                    printf("Image 8 bits sauvegardee !\n");
+                    if (bmp8_saveImage(filename, image8) == 0) printf("Image 8 bits sauvegardee !\n");
                 } else if (image24) {
-                    bmp24_saveImage(image24, filename);
-                    printf("Image 24 bits sauvegardee !\n");
+                    if (bmp24_saveImage(image24, filename) == 0) printf("Image 24 bits sauvegardee !\n");
                 } else {
                     printf("Aucune image à sauvegarder.\n");
                 }
@@ -182,7 +250,40 @@ int main(void) {
                             break;
                         }
                         case 9: bmp8_equalizeHistogram(image8); break;
-                        case 10: break;
+                        case 10: bmp8_clahe(image8, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_CLIP); break;
+                        case 11: {
+                            t_bmp24 *converted = bmp24_fromBmp8(image8);
+                            if (converted) {
+                                bmp8_free(image8);
+                                image8 = NULL;
+                                image24 = converted;
+                                printf("Image convertie en 24 bits.\n");
+                            }
+                            break;
+                        }
+                        case 12: {
+                            int op, w, h;
+                            printf("Operation (1 = erosion, 2 = dilatation, 3 = ouverture, 4 = fermeture, 5 = gradient) : "); scanf("%d", &op);
+                            printf("Element structurant (largeur hauteur) : "); scanf("%d %d", &w, &h);
+                            switch (op) {
+                                case 1: morpho_erode(image8, w, h); break;
+                                case 2: morpho_dilate(image8, w, h); break;
+                                case 3: morpho_open(image8, w, h); break;
+                                case 4: morpho_close(image8, w, h); break;
+                                case 5: morpho_gradient(image8, w, h); break;
+                                default: printf("Operation invalide.\n"); break;
+                            }
+                            break;
+                        }
+                        case 13: {
+                            int connectivity;
+                            printf("Connexite (4 ou 8) : "); scanf("%d", &connectivity);
+                            t_components *components = components_label(image8, connectivity == 4 ? COMPONENTS_4 : COMPONENTS_8);
+                            components_print(components, 20);
+                            components_free(components);
+                            break;
+                        }
+                        case 14: break;
                         default: printf("Filtre invalide.\n");
                     }
                     printf("Filtre 8 bits applique.\n");
@@ -215,7 +316,35 @@ int main(void) {
                             break;
                         }
                         case 5: bmp24_equalizeHistogram(image24); break;
-                        case 6: break;
+                        case 6: bmp24_clahe(image24, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_TILES, CLAHE_DEFAULT_CLIP); break;
+                        case 7: {
+                            int standard;
+                            printf("Coefficients (1 = BT.601, 2 = BT.709) : "); scanf("%d", &standard);
+                            t_bmp8 *converted = bmp24_toGray8(image24, standard == 2 ? GRAY_BT709 : GRAY_BT601);
+                            if (converted) {
+                                bmp24_free(image24);
+                                image24 = NULL;
+                                image8 = converted;
+                                printf("Image convertie en 8 bits.\n");
+                            }
+                            break;
+                        }
+                        case 8: {
+                            int dither;
+                            printf("Tramage (1 = aucun, 2 = ordonne, 3 = Floyd-Steinberg) : "); scanf("%d", &dither);
+                            t_dither mode = DITHER_NONE;
+                            if (dither == 2) mode = DITHER_ORDERED;
+                            else if (dither == 3) mode = DITHER_FLOYD_STEINBERG;
+                            t_bmp8 *converted = quantize_image(image24, QUANTIZE_MAX_COLORS, mode);
+                            if (converted) {
+                                bmp24_free(image24);
+                                image24 = NULL;
+                                image8 = converted;
+                                printf("Image convertie en 8 bits (palette de couleurs).\n");
+                            }
+                            break;
+                        }
+                        case 9: break;
                         default: printf("Filtre invalide.\n"); break;
                     }
                     printf("Filtre 24 bits appliqué.\n");
@@ -240,7 +369,7 @@ int main(void) {
                 if (image8) bmp8_free(image8);
                 if (image24) bmp24_free(image24);
                 printf("Au revoir !\n");
-                return 0;
+                return terminer(0);
 
             default:
                 printf("Option invalide.\n");
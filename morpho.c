@@ -0,0 +1,464 @@
+#include "morpho.h"
+#include "histogram.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Opération élémentaire d'une passe : min / max sur des intensités,
+// ET / OU sur des lignes compactées
+typedef enum {
+    MORPHO_MIN,
+    MORPHO_MAX,
+    MORPHO_AND,
+    MORPHO_OR
+} t_morphoOp;
+
+// Opération demandée par l'interface publique
+typedef enum {
+    MORPHO_MODE_ERODE,
+    MORPHO_MODE_DILATE,
+    MORPHO_MODE_OPEN,
+    MORPHO_MODE_CLOSE,
+    MORPHO_MODE_GRADIENT
+} t_morphoMode;
+
+// Zones de travail, allouées avant la première passe : chaque passe est
+// découpée en au plus chunks morceaux, chacun avec sa zone de chunkSize
+// octets, si bien qu'aucune tâche n'alloue (ni ne peut échouer)
+typedef struct {
+    unsigned char *buffer;
+    size_t chunkSize;
+    int chunks;
+    uint64_t *bits;         // lignes compactées (images binaires)
+} t_morphoScratch;
+
+// Contexte partagé par les tâches d'une passe
+typedef struct {
+    unsigned char *plane;   // pixels, ou lignes compactées vues comme des octets
+    uint64_t *bits;         // lignes compactées (words mots par ligne)
+    int width;              // largeur en pixels (ou en octets pour la passe verticale)
+    int height;
+    int words;
+    int size;               // taille de l'élément dans la direction de la passe
+    int anchor;             // la fenêtre du pixel x commence en x - anchor
+    t_morphoOp op;
+    const t_morphoScratch *scratch;
+    int grain;              // éléments par morceau
+} t_morphoJob;
+
+// Zone de travail du morceau qui commence en begin
+static unsigned char *morpho_chunkScratch(const t_morphoJob *job, int begin) {
+    return job->scratch->buffer + (size_t)(begin / job->grain) * job->scratch->chunkSize;
+}
+
+// Exécute fn sur [0, count) en au plus scratch->chunks morceaux
+static void morpho_run(t_morphoJob *job, int count, t_rangeTask fn) {
+    job->grain = (count + job->scratch->chunks - 1) / job->scratch->chunks;
+    threadpool_parallelFor(0, count, job->grain, fn, job);
+}
+
+static unsigned char morpho_neutral(t_morphoOp op) {
+    return (op == MORPHO_MIN || op == MORPHO_AND) ? 255 : 0;
+}
+
+// dst = a op b, élément par élément (dst peut être a ou b)
+static void morpho_combine(unsigned char *dst, const unsigned char *a, const unsigned char *b, int n, t_morphoOp op) {
+    switch (op) {
+        case MORPHO_MIN:
+            for (int i = 0; i < n; i++) dst[i] = a[i] < b[i] ? a[i] : b[i];
+            break;
+        case MORPHO_MAX:
+            for (int i = 0; i < n; i++) dst[i] = a[i] > b[i] ? a[i] : b[i];
+            break;
+        case MORPHO_AND:
+            for (int i = 0; i < n; i++) dst[i] = a[i] & b[i];
+            break;
+        case MORPHO_OR:
+            for (int i = 0; i < n; i++) dst[i] = a[i] | b[i];
+            break;
+    }
+}
+
+// --- Niveaux de gris : van Herk / Gil-Werman ---
+
+/**
+ * Cumuls par blocs de k éléments : g[j] depuis le début du bloc de j,
+ * h[j] jusqu'à sa fin. Le résultat sur la fenêtre [i, i + k - 1] est alors
+ * op(h[i], g[i + k - 1]), puisqu'elle chevauche au plus deux blocs.
+ */
+static void morpho_blockScans(const unsigned char *p, unsigned char *g, unsigned char *h, int length, int k, t_morphoOp op) {
+    if (op == MORPHO_MAX) {
+        for (int j = 0; j < length; j++) {
+            g[j] = (j % k == 0 || p[j] > g[j - 1]) ? p[j] : g[j - 1];
+        }
+        for (int j = length - 1; j >= 0; j--) {
+            h[j] = (j % k == k - 1 || j == length - 1 || p[j] > h[j + 1]) ? p[j] : h[j + 1];
+        }
+    } else {
+        for (int j = 0; j < length; j++) {
+            g[j] = (j % k == 0 || p[j] < g[j - 1]) ? p[j] : g[j - 1];
+        }
+        for (int j = length - 1; j >= 0; j--) {
+            h[j] = (j % k == k - 1 || j == length - 1 || p[j] < h[j + 1]) ? p[j] : h[j + 1];
+        }
+    }
+}
+
+static void morpho_horizontalRows(void *ctx, int begin, int end) {
+    t_morphoJob *job = (t_morphoJob *)ctx;
+    int k = job->size;
+    int width = job->width;
+    int length = width + k - 1;
+    unsigned char *buffer = morpho_chunkScratch(job, begin);
+    unsigned char *padded = buffer;
+    unsigned char *g = buffer + length;
+    unsigned char *h = buffer + 2 * (size_t)length;
+
+    // Ligne complétée par l'élément neutre : padded[j] = row[j - anchor]
+    memset(padded, morpho_neutral(job->op), length);
+    for (int y = begin; y < end; y++) {
+        unsigned char *row = job->plane + (size_t)y * width;
+        memcpy(padded + job->anchor, row, width);
+        morpho_blockScans(padded, g, h, length, k, job->op);
+        morpho_combine(row, h, g + k - 1, width, job->op);
+    }
+}
+
+/**
+ * Passe verticale sur des bandes de colonnes : les cumuls par blocs se
+ * font ligne entière contre ligne entière (accès contigus, vectorisables).
+ * Sert aussi aux lignes compactées, vues comme des octets (ET / OU).
+ */
+static void morpho_verticalBands(void *ctx, int begin, int end) {
+    t_morphoJob *job = (t_morphoJob *)ctx;
+    int k = job->size;
+    int length = job->height + k - 1;
+    unsigned char *g = morpho_chunkScratch(job, begin);
+    unsigned char *h = g + (size_t)length * MORPHO_BAND;
+    unsigned char neutral[MORPHO_BAND];
+    memset(neutral, morpho_neutral(job->op), sizeof(neutral));
+
+    for (int band = begin; band < end; band++) {
+        int x0 = band * MORPHO_BAND;
+        int n = (job->width - x0 < MORPHO_BAND) ? job->width - x0 : MORPHO_BAND;
+
+        // Ligne j de la colonne complétée : ligne j - anchor de l'image, ou neutre
+        for (int j = 0; j < length; j++) {
+            int y = j - job->anchor;
+            const unsigned char *p = (y >= 0 && y < job->height) ? job->plane + (size_t)y * job->width + x0 : neutral;
+            unsigned char *gj = g + (size_t)j * n;
+            if (j % k == 0) memcpy(gj, p, n);
+            else morpho_combine(gj, gj - n, p, n, job->op);
+        }
+        for (int j = length - 1; j >= 0; j--) {
+            int y = j - job->anchor;
+            const unsigned char *p = (y >= 0 && y < job->height) ? job->plane + (size_t)y * job->width + x0 : neutral;
+            unsigned char *hj = h + (size_t)j * n;
+            if (j % k == k - 1 || j == length - 1) memcpy(hj, p, n);
+            else morpho_combine(hj, hj + n, p, n, job->op);
+        }
+        for (int y = 0; y < job->height; y++) {
+            morpho_combine(job->plane + (size_t)y * job->width + x0, h + (size_t)y * n, g + (size_t)(y + k - 1) * n, n, job->op);
+        }
+    }
+}
+
+static void morpho_vertical(t_morphoJob *job) {
+    morpho_run(job, (job->width + MORPHO_BAND - 1) / MORPHO_BAND, morpho_verticalBands);
+}
+
+// --- Images binaires : 64 pixels par mot (bit x % 64 du mot x / 64) ---
+
+// dst[x] = src[x + s] ; au-delà de la fin, fill
+static void morpho_shiftDown(const uint64_t *src, uint64_t *dst, int words, int s, uint64_t fill) {
+    int ws = s >> 6;
+    int bs = s & 63;
+    for (int w = 0; w < words; w++) {
+        uint64_t lo = (w + ws < words) ? src[w + ws] : fill;
+        uint64_t hi = (w + ws + 1 < words) ? src[w + ws + 1] : fill;
+        dst[w] = bs ? (lo >> bs) | (hi << (64 - bs)) : lo;
+    }
+}
+
+// dst[x] = src[x - s] ; avant le début, fill
+static void morpho_shiftUp(const uint64_t *src, uint64_t *dst, int words, int s, uint64_t fill) {
+    int ws = s >> 6;
+    int bs = s & 63;
+    for (int w = 0; w < words; w++) {
+        uint64_t hi = (w - ws >= 0) ? src[w - ws] : fill;
+        uint64_t lo = (w - ws - 1 >= 0) ? src[w - ws - 1] : fill;
+        dst[w] = bs ? (hi << bs) | (lo >> (64 - bs)) : hi;
+    }
+}
+
+static void morpho_packRows(void *ctx, int begin, int end) {
+    t_morphoJob *job = (t_morphoJob *)ctx;
+    for (int y = begin; y < end; y++) {
+        const unsigned char *row = job->plane + (size_t)y * job->width;
+        uint64_t *bits = job->bits + (size_t)y * job->words;
+        memset(bits, 0, (size_t)job->words * sizeof(uint64_t));
+        for (int x = 0; x < job->width; x++) {
+            bits[x >> 6] |= (uint64_t)(row[x] != 0) << (x & 63);
+        }
+    }
+}
+
+static void morpho_unpackRows(void *ctx, int begin, int end) {
+    t_morphoJob *job = (t_morphoJob *)ctx;
+    for (int y = begin; y < end; y++) {
+        unsigned char *row = job->plane + (size_t)y * job->width;
+        const uint64_t *bits = job->bits + (size_t)y * job->words;
+        for (int x = 0; x < job->width; x++) {
+            row[x] = ((bits[x >> 6] >> (x & 63)) & 1) ? 255 : 0;
+        }
+    }
+}
+
+/**
+ * Passe horizontale sur lignes compactées : après un décalage de anchor,
+ * la fenêtre [x, x + k - 1] s'obtient par doublement (fenêtres de 1, 2,
+ * 4... pixels combinées avec leur copie décalée), soit log2(k) opérations
+ * par mot de 64 pixels.
+ */
+static void morpho_horizontalBits(void *ctx, int begin, int end) {
+    t_morphoJob *job = (t_morphoJob *)ctx;
+    int k = job->size;
+    int padWords = (job->width + k + 63) / 64;  // place pour les pixels décalés
+    uint64_t fill = job->op == MORPHO_AND ? ~(uint64_t)0 : 0;
+    uint64_t *buffer = (uint64_t *)morpho_chunkScratch(job, begin);
+    uint64_t *line = buffer;
+    uint64_t *window = buffer + padWords;
+    uint64_t *shifted = buffer + 2 * (size_t)padWords;
+    uint64_t lastMask = (job->width & 63) ? ((uint64_t)1 << (job->width & 63)) - 1 : ~(uint64_t)0;
+
+    for (int y = begin; y < end; y++) {
+        uint64_t *row = job->bits + (size_t)y * job->words;
+
+        // Ligne complétée par l'élément neutre au-delà de width
+        for (int w = 0; w < padWords; w++) {
+            line[w] = w < job->words ? row[w] : fill;
+        }
+        line[job->words - 1] = (line[job->words - 1] & lastMask) | (fill & ~lastMask);
+
+        morpho_shiftUp(line, window, padWords, job->anchor, fill);
+        int length = 1;
+        while (2 * length <= k) {
+            morpho_shiftDown(window, shifted, padWords, length, fill);
+            morpho_combine((unsigned char *)window, (unsigned char *)window, (unsigned char *)shifted,
+                           padWords * (int)sizeof(uint64_t), job->op);
+            length *= 2;
+        }
+        if (length < k) {
+            morpho_shiftDown(window, shifted, padWords, k - length, fill);
+            morpho_combine((unsigned char *)window, (unsigned char *)window, (unsigned char *)shifted,
+                           padWords * (int)sizeof(uint64_t), job->op);
+        }
+        memcpy(row, window, (size_t)job->words * sizeof(uint64_t));
+    }
+}
+
+// --- Passes complètes ---
+
+/**
+ * Alloue les zones de travail de toutes les passes d'une opération
+ * @return 0 si succès, -1 en cas d'échec d'allocation
+ */
+static int morpho_scratchInit(t_morphoScratch *scratch, int width, int height, int kw, int kh, int binary) {
+    memset(scratch, 0, sizeof(*scratch));
+    scratch->chunks = threadpool_threadCount();
+
+    size_t horizontal = 0;
+    size_t vertical = 2 * (size_t)(height + kh - 1) * MORPHO_BAND;
+    if (binary) {
+        int words = (width + 63) / 64;
+        horizontal = 3 * (size_t)((width + kw + 63) / 64) * sizeof(uint64_t);
+        scratch->bits = (uint64_t *)malloc((size_t)words * height * sizeof(uint64_t));
+        if (!scratch->bits) return -1;
+        PROFILE_ALLOC((size_t)words * height * sizeof(uint64_t));
+    } else {
+        horizontal = 3 * (size_t)(width + kw - 1);
+    }
+    size_t chunkSize = horizontal > vertical ? horizontal : vertical;
+    scratch->chunkSize = (chunkSize + 7) & ~(size_t)7;  // lignes compactées alignées
+    scratch->buffer = (unsigned char *)malloc(scratch->chunkSize * scratch->chunks);
+    if (!scratch->buffer) return -1;
+    PROFILE_ALLOC(scratch->chunkSize * scratch->chunks);
+    return 0;
+}
+
+static void morpho_scratchFree(t_morphoScratch *scratch) {
+    free(scratch->buffer);
+    free(scratch->bits);
+}
+
+/**
+ * Érosion ou dilatation d'un plan (lignes dans l'ordre de stockage, de bas
+ * en haut) par un rectangle kw x kh, avec des zones de travail déjà allouées
+ */
+static void morpho_plane(unsigned char *plane, int width, int height, int kw, int kh, int dilate, int binary,
+                         const t_morphoScratch *scratch) {
+    // Fenêtres : [x - (kw - 1) / 2, x + kw / 2] en colonnes et, en lignes
+    // de haut en bas, [y - (kh - 1) / 2, y + kh / 2] ; la dilatation utilise
+    // l'élément réfléchi, pour que ouverture et fermeture soient exactes
+    int anchorX = dilate ? kw / 2 : (kw - 1) / 2;
+    int anchorY = dilate ? (kh - 1) / 2 : kh / 2;  // lignes stockées de bas en haut
+
+    if (!binary) {
+        t_morphoOp op = dilate ? MORPHO_MAX : MORPHO_MIN;
+        t_morphoJob job = {plane, NULL, width, height, 0, kw, anchorX, op, scratch, 1};
+        if (kw > 1) morpho_run(&job, height, morpho_horizontalRows);
+        job.size = kh;
+        job.anchor = anchorY;
+        if (kh > 1) morpho_vertical(&job);
+        return;
+    }
+
+    int words = (width + 63) / 64;
+    t_morphoOp op = dilate ? MORPHO_OR : MORPHO_AND;
+    t_morphoJob job = {plane, scratch->bits, width, height, words, kw, anchorX, op, scratch, 1};
+    morpho_run(&job, height, morpho_packRows);
+    if (kw > 1) morpho_run(&job, height, morpho_horizontalBits);
+    if (kh > 1) {
+        // Les lignes compactées sont combinées octet par octet (ET / OU)
+        t_morphoJob vertical = {(unsigned char *)scratch->bits, NULL, words * (int)sizeof(uint64_t), height, 0, kh, anchorY, op, scratch, 1};
+        morpho_vertical(&vertical);
+    }
+    morpho_run(&job, height, morpho_unpackRows);
+}
+
+// Image composée uniquement de 0 et de 255
+static int morpho_isBinary(const t_bmp8 *img) {
+    int histogram[256];
+    histogram_compute(img->data, img->dataSize, histogram);
+    return (size_t)histogram[0] + histogram[255] == img->dataSize;
+}
+
+/**
+ * Vérifie les paramètres, alloue tout ce qu'il faut puis enchaîne les
+ * passes : en cas d'échec, l'image n'est pas modifiée
+ * @return Nombre de pixels traités (0 en cas d'erreur)
+ */
+static size_t morpho_apply(t_bmp8 *img, int seWidth, int seHeight, t_morphoMode mode) {
+    if (!img || !img->data) return 0;
+    if (seWidth < 1 || seHeight < 1) {
+        printf("Erreur : Element structurant invalide (%d x %d)\n", seWidth, seHeight);
+        return 0;
+    }
+    bmp8_applyPalette(img);
+
+    // À partir de 2n - 1, chaque fenêtre couvre la ligne (ou la colonne)
+    // entière : un élément plus grand donne le même résultat
+    int width = (int)img->width;
+    int height = (int)img->height;
+    if (seWidth > 2 * width - 1) seWidth = 2 * width - 1;
+    if (seHeight > 2 * height - 1) seHeight = 2 * height - 1;
+    int binary = morpho_isBinary(img);
+
+    t_morphoScratch scratch;
+    unsigned char *eroded = NULL;
+    if (morpho_scratchInit(&scratch, width, height, seWidth, seHeight, binary) != 0 ||
+        (mode == MORPHO_MODE_GRADIENT && !(eroded = (unsigned char *)malloc(img->dataSize)))) {
+        printf("Erreur : Allocation memoire echouee pour la morphologie\n");
+        morpho_scratchFree(&scratch);
+        return 0;
+    }
+
+    switch (mode) {
+        case MORPHO_MODE_ERODE:
+            morpho_plane(img->data, width, height, seWidth, seHeight, 0, binary, &scratch);
+            break;
+        case MORPHO_MODE_DILATE:
+            morpho_plane(img->data, width, height, seWidth, seHeight, 1, binary, &scratch);
+            break;
+        case MORPHO_MODE_OPEN:
+            morpho_plane(img->data, width, height, seWidth, seHeight, 0, binary, &scratch);
+            morpho_plane(img->data, width, height, seWidth, seHeight, 1, binary, &scratch);
+            break;
+        case MORPHO_MODE_CLOSE:
+            morpho_plane(img->data, width, height, seWidth, seHeight, 1, binary, &scratch);
+            morpho_plane(img->data, width, height, seWidth, seHeight, 0, binary, &scratch);
+            break;
+        case MORPHO_MODE_GRADIENT:
+            PROFILE_ALLOC(img->dataSize);
+            memcpy(eroded, img->data, img->dataSize);
+            morpho_plane(eroded, width, height, seWidth, seHeight, 0, binary, &scratch);
+            morpho_plane(img->data, width, height, seWidth, seHeight, 1, binary, &scratch);
+            // L'élément contient son centre : dilatation >= image >= érosion
+            for (size_t i = 0; i < img->dataSize; i++) {
+                img->data[i] = (unsigned char)(img->data[i] - eroded[i]);
+            }
+            break;
+    }
+
+    free(eroded);
+    morpho_scratchFree(&scratch);
+    return img->dataSize;
+}
+
+/**
+ * Érosion : minimum sur le rectangle (amincit les objets clairs)
+ * @param img Image à modifier
+ * @param seWidth Largeur de l'élément structurant
+ * @param seHeight Hauteur de l'élément structurant
+ */
+void morpho_erode(t_bmp8 *img, int seWidth, int seHeight) {
+    PROFILE_BEGIN(morpho_erode);
+    size_t pixels = morpho_apply(img, seWidth, seHeight, MORPHO_MODE_ERODE);
+    PROFILE_END(morpho_erode, pixels);
+    (void)pixels;  // inutilisée sans PROJETC_PROFILING
+}
+
+/**
+ * Dilatation : maximum sur le rectangle (épaissit les objets clairs)
+ * @param img Image à modifier
+ * @param seWidth Largeur de l'élément structurant
+ * @param seHeight Hauteur de l'élément structurant
+ */
+void morpho_dilate(t_bmp8 *img, int seWidth, int seHeight) {
+    PROFILE_BEGIN(morpho_dilate);
+    size_t pixels = morpho_apply(img, seWidth, seHeight, MORPHO_MODE_DILATE);
+    PROFILE_END(morpho_dilate, pixels);
+    (void)pixels;
+}
+
+/**
+ * Ouverture : érosion puis dilatation (supprime les petits objets clairs)
+ * @param img Image à modifier
+ * @param seWidth Largeur de l'élément structurant
+ * @param seHeight Hauteur de l'élément structurant
+ */
+void morpho_open(t_bmp8 *img, int seWidth, int seHeight) {
+    PROFILE_BEGIN(morpho_open);
+    size_t pixels = morpho_apply(img, seWidth, seHeight, MORPHO_MODE_OPEN);
+    PROFILE_END(morpho_open, pixels);
+    (void)pixels;
+}
+
+/**
+ * Fermeture : dilatation puis érosion (bouche les petits trous sombres)
+ * @param img Image à modifier
+ * @param seWidth Largeur de l'élément structurant
+ * @param seHeight Hauteur de l'élément structurant
+ */
+void morpho_close(t_bmp8 *img, int seWidth, int seHeight) {
+    PROFILE_BEGIN(morpho_close);
+    size_t pixels = morpho_apply(img, seWidth, seHeight, MORPHO_MODE_CLOSE);
+    PROFILE_END(morpho_close, pixels);
+    (void)pixels;
+}
+
+/**
+ * Gradient morphologique : dilatation - érosion
+ * @param img Image à modifier
+ * @param seWidth Largeur de l'élément structurant
+ * @param seHeight Hauteur de l'élément structurant
+ */
+void morpho_gradient(t_bmp8 *img, int seWidth, int seHeight) {
+    PROFILE_BEGIN(morpho_gradient);
+    size_t pixels = morpho_apply(img, seWidth, seHeight, MORPHO_MODE_GRADIENT);
+    PROFILE_END(morpho_gradient, pixels);
+    (void)pixels;
+}
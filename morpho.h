@@ -0,0 +1,30 @@
+#ifndef MORPHO_H
+#define MORPHO_H
+
+#include "bmp8.h"
+
+// Morphologie mathématique sur les images 8 bits, avec un élément
+// structurant rectangulaire seWidth x seHeight centré sur le pixel (pour
+// une taille paire, la colonne ou la ligne en plus est à droite / en bas).
+// Les pixels hors de l'image sont neutres : ils ne réduisent pas une
+// érosion et n'augmentent pas une dilatation.
+//
+// Le rectangle est séparable (passe horizontale puis verticale) et chaque
+// passe suit l'algorithme de van Herk / Gil-Werman : maxima / minima
+// cumulés par blocs de la taille de l'élément, soit 3 comparaisons par
+// pixel quelle que soit sa taille. Une image binaire (uniquement 0 et 255,
+// par exemple après bmp8_threshold) est traitée sur des lignes compactées
+// à 64 pixels par mot : ET / OU de lignes entières en vertical, décalages
+// par doublement en horizontal.
+
+// Largeur (en octets) des bandes de colonnes de la passe verticale
+#define MORPHO_BAND 256
+
+void morpho_erode(t_bmp8 *img, int seWidth, int seHeight);
+void morpho_dilate(t_bmp8 *img, int seWidth, int seHeight);
+void morpho_open(t_bmp8 *img, int seWidth, int seHeight);
+void morpho_close(t_bmp8 *img, int seWidth, int seHeight);
+// Gradient morphologique : dilatation - érosion (contours des objets)
+void morpho_gradient(t_bmp8 *img, int seWidth, int seHeight);
+
+#endif // MORPHO_H
@@ -0,0 +1,609 @@
+#include "pipeline.h"
+#include "fft.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <string.h>
+#include <math.h>
+
+// Composition d'opérations ponctuelles : table A sur chaque canal, puis
+// éventuellement passage en niveaux de gris suivi de la table B. Un second
+// passage en gris est sans effet (canaux déjà égaux), donc toute suite
+// d'opérations ponctuelles se ramène à cette forme.
+typedef struct {
+    unsigned char lutA[256];
+    int gray;
+    unsigned char lutB[256];
+} t_pointStage;
+
+static void point_reset(t_pointStage *s) {
+    for (int i = 0; i < 256; i++) {
+        s->lutA[i] = (unsigned char)i;
+        s->lutB[i] = (unsigned char)i;
+    }
+    s->gray = 0;
+}
+
+static int point_isIdentity(const t_pointStage *s) {
+    if (s->gray) return 0;
+    for (int i = 0; i < 256; i++) {
+        if (s->lutA[i] != i) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Ajoute une opération ponctuelle à la composition courante
+ * @param s Composition à compléter
+ * @param op Opération (négatif, luminosité, seuil ou niveaux de gris)
+ * @param is24 1 si l'image est en 24 bits (le gris n'a de sens qu'en couleur)
+ */
+static void point_append(t_pointStage *s, const t_op *op, int is24) {
+    if (op->type == OP_GRAYSCALE) {
+        if (is24 && !s->gray) {
+            s->gray = 1;
+            for (int i = 0; i < 256; i++) s->lutB[i] = (unsigned char)i;
+        }
+        return;
+    }
+
+    unsigned char *lut = s->gray ? s->lutB : s->lutA;
+    for (int i = 0; i < 256; i++) {
+        int v = lut[i];
+        switch (op->type) {
+            case OP_NEGATIVE: v = 255 - v; break;
+            case OP_BRIGHTNESS:
+                v += op->value;
+                if (v > 255) v = 255;
+                if (v < 0) v = 0;
+                break;
+            case OP_THRESHOLD: v = (v >= op->value) ? 255 : 0; break;
+            default: break;
+        }
+        lut[i] = (unsigned char)v;
+    }
+}
+
+static inline t_pixel point_apply24(const t_pointStage *s, t_pixel p) {
+    p.red = s->lutA[p.red];
+    p.green = s->lutA[p.green];
+    p.blue = s->lutA[p.blue];
+    if (s->gray) {
+        uint8_t v = s->lutB[(p.red + p.green + p.blue) / 3];
+        p.red = v;
+        p.green = v;
+        p.blue = v;
+    }
+    return p;
+}
+
+static int op_isPoint(const t_op *op) {
+    return op->type == OP_NEGATIVE || op->type == OP_BRIGHTNESS ||
+           op->type == OP_THRESHOLD || op->type == OP_GRAYSCALE;
+}
+
+/**
+ * Crée un pipeline différé sur une image 8 bits
+ * @param img Image cible (modifiée à l'exécution, non libérée par le pipeline)
+ * @return Pipeline vide, NULL en cas d'échec
+ */
+t_pipeline *pipeline_create8(t_bmp8 *img) {
+    if (!img) return NULL;
+    t_pipeline *p = (t_pipeline *)calloc(1, sizeof(t_pipeline));
+    if (!p) return NULL;
+    p->img8 = img;
+    return p;
+}
+
+/**
+ * Crée un pipeline différé sur une image 24 bits
+ * @param img Image cible (modifiée à l'exécution, non libérée par le pipeline)
+ * @return Pipeline vide, NULL en cas d'échec
+ */
+t_pipeline *pipeline_create24(t_bmp24 *img) {
+    if (!img) return NULL;
+    t_pipeline *p = (t_pipeline *)calloc(1, sizeof(t_pipeline));
+    if (!p) return NULL;
+    p->img24 = img;
+    return p;
+}
+
+/**
+ * Vide la liste des opérations enregistrées sans les exécuter
+ * @param p Pipeline
+ */
+void pipeline_clear(t_pipeline *p) {
+    for (int i = 0; i < p->count; i++) {
+        free(p->ops[i].kernel);
+    }
+    p->count = 0;
+}
+
+/**
+ * Libère le pipeline (l'image associée reste à la charge de l'appelant)
+ * @param p Pipeline à libérer
+ */
+void pipeline_free(t_pipeline *p) {
+    if (!p) return;
+    pipeline_clear(p);
+    free(p->ops);
+    free(p);
+}
+
+static t_op *pipeline_push(t_pipeline *p, t_opType type) {
+    if (!p) return NULL;
+    if (p->count == p->capacity) {
+        int capacity = p->capacity ? p->capacity * 2 : 8;
+        t_op *ops = (t_op *)realloc(p->ops, capacity * sizeof(t_op));
+        if (!ops) {
+            printf("Erreur : Allocation memoire echouee pour le pipeline.\n");
+            return NULL;
+        }
+        p->ops = ops;
+        p->capacity = capacity;
+    }
+    t_op *op = &p->ops[p->count++];
+    memset(op, 0, sizeof(t_op));
+    op->type = type;
+    return op;
+}
+
+void pipeline_negative(t_pipeline *p) {
+    pipeline_push(p, OP_NEGATIVE);
+}
+
+void pipeline_brightness(t_pipeline *p, int value) {
+    t_op *op = pipeline_push(p, OP_BRIGHTNESS);
+    if (op) op->value = value;
+}
+
+void pipeline_threshold(t_pipeline *p, int threshold) {
+    t_op *op = pipeline_push(p, OP_THRESHOLD);
+    if (op) op->value = threshold;
+}
+
+void pipeline_grayscale(t_pipeline *p) {
+    pipeline_push(p, OP_GRAYSCALE);
+}
+
+void pipeline_equalize(t_pipeline *p) {
+    pipeline_push(p, OP_EQUALIZE);
+}
+
+/**
+ * Enregistre une convolution ; le noyau est copié, l'appelant peut le libérer
+ * @param p Pipeline
+ * @param kernel Noyau de convolution
+ * @param kernelSize Taille du noyau (impaire)
+ */
+void pipeline_filter(t_pipeline *p, float **kernel, int kernelSize) {
+    if (!kernel || kernelSize <= 0) return;
+    float *copy = (float *)malloc(kernelSize * kernelSize * sizeof(float));
+    if (!copy) {
+        printf("Erreur : Allocation memoire echouee pour le pipeline.\n");
+        return;
+    }
+    for (int i = 0; i < kernelSize; i++) {
+        memcpy(copy + i * kernelSize, kernel[i], kernelSize * sizeof(float));
+    }
+    t_op *op = pipeline_push(p, OP_FILTER);
+    if (!op) {
+        free(copy);
+        return;
+    }
+    op->kernelSize = kernelSize;
+    op->kernel = copy;
+}
+
+// Noyaux 3x3 nommés de pipeline_parse (mêmes valeurs que les menus)
+typedef struct {
+    const char *name;
+    int values[3][3];
+    float divisor;
+} t_namedKernel;
+
+static const t_namedKernel namedKernels[] = {
+    {"box",      {{1, 1, 1}, {1, 1, 1}, {1, 1, 1}}, 9.0f},
+    {"gaussian", {{1, 2, 1}, {2, 4, 2}, {1, 2, 1}}, 16.0f},
+    {"outline",  {{-1, -1, -1}, {-1, 8, -1}, {-1, -1, -1}}, 1.0f},
+    {"emboss",   {{-2, -1, 0}, {-1, 1, 1}, {0, 1, 2}}, 1.0f},
+    {"sharpen",  {{0, -1, 0}, {-1, 5, -1}, {0, -1, 0}}, 1.0f}
+};
+
+/**
+ * Enregistre une opération décrite en texte ("nom" ou "nom:valeur")
+ * @return 0 si succès, -1 si l'opération est inconnue ou mal formée
+ */
+static int pipeline_parseOp(t_pipeline *p, const char *name, const char *arg) {
+    char *end = NULL;
+    long value = arg ? strtol(arg, &end, 10) : 0;
+    int hasValue = arg && *arg && *end == '\0';
+    int before = p->count;
+
+    if (strcmp(name, "negative") == 0 && !arg) pipeline_negative(p);
+    else if (strcmp(name, "gray") == 0 && !arg) pipeline_grayscale(p);
+    else if (strcmp(name, "equalize") == 0 && !arg) pipeline_equalize(p);
+    else if (strcmp(name, "brightness") == 0 && hasValue) pipeline_brightness(p, (int)value);
+    else if (strcmp(name, "threshold") == 0 && hasValue) pipeline_threshold(p, (int)value);
+    else if (strcmp(name, "box") == 0 && hasValue) {
+        // Flou moyen N x N (N impair), les grands noyaux passent par la FFT
+        if (value < 1 || value > 255 || value % 2 == 0) return -1;
+        int size = (int)value;
+        float *values = (float *)malloc((size_t)size * size * sizeof(float));
+        float **kernel = (float **)malloc(size * sizeof(float *));
+        if (values && kernel) {
+            for (int i = 0; i < size * size; i++) values[i] = 1.0f / (size * size);
+            for (int i = 0; i < size; i++) kernel[i] = values + i * size;
+            pipeline_filter(p, kernel, size);
+        }
+        free(values);
+        free(kernel);
+    } else {
+        for (size_t k = 0; k < sizeof(namedKernels) / sizeof(namedKernels[0]); k++) {
+            if (strcmp(name, namedKernels[k].name) != 0 || arg) continue;
+            float rows[3][3];
+            float *kernel[3] = {rows[0], rows[1], rows[2]};
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) rows[i][j] = namedKernels[k].values[i][j] / namedKernels[k].divisor;
+            }
+            pipeline_filter(p, kernel, 3);
+            break;
+        }
+    }
+    return p->count > before ? 0 : -1;
+}
+
+/**
+ * Enregistre une chaîne d'opérations séparées par des virgules, par exemple
+ * "gray,brightness:20,gaussian,threshold:128". Opérations reconnues :
+ * negative, gray, equalize, brightness:N, threshold:N, box, gaussian,
+ * outline, emboss, sharpen et box:N (flou moyen N x N).
+ * @param p Pipeline
+ * @param chain Chaîne d'opérations
+ * @return 0 si succès, -1 en cas d'erreur (aucune opération n'est alors ajoutée)
+ */
+int pipeline_parse(t_pipeline *p, const char *chain) {
+    if (!p || !chain) return -1;
+    char *copy = strdup(chain);
+    if (!copy) return -1;
+
+    int before = p->count;
+    int status = 0;
+    char *save = NULL;
+    for (char *token = strtok_r(copy, ",", &save); token; token = strtok_r(NULL, ",", &save)) {
+        char *arg = strchr(token, ':');
+        if (arg) *arg++ = '\0';
+        if (pipeline_parseOp(p, token, arg) != 0) {
+            printf("Erreur : Operation inconnue ou invalide : %s\n", token);
+            status = -1;
+            break;
+        }
+    }
+    free(copy);
+
+    if (status != 0) {
+        for (int i = before; i < p->count; i++) free(p->ops[i].kernel);
+        p->count = before;
+    }
+    return status;
+}
+
+/**
+ * Encodage canonique des opérations en attente, utilisé comme clé de cache.
+ * Chaque opération est écrite avec tous ses paramètres ; un noyau est
+ * représenté par sa taille et une empreinte FNV-1a de ses coefficients.
+ * @param p Pipeline
+ * @return Chaîne allouée (à libérer par l'appelant), NULL en cas d'échec
+ */
+char *pipeline_describe(const t_pipeline *p) {
+    if (!p) return NULL;
+    // 40 octets suffisent pour la plus longue opération ("filter:N:empreinte,")
+    size_t size = (size_t)p->count * 40 + 8;
+    char *text = (char *)malloc(size);
+    if (!text) return NULL;
+
+    size_t len = (size_t)snprintf(text, size, "%s", p->img8 ? "8" : "24");
+    for (int i = 0; i < p->count; i++) {
+        const t_op *op = &p->ops[i];
+        switch (op->type) {
+            case OP_NEGATIVE: len += snprintf(text + len, size - len, ",negative"); break;
+            case OP_BRIGHTNESS: len += snprintf(text + len, size - len, ",brightness:%d", op->value); break;
+            case OP_THRESHOLD: len += snprintf(text + len, size - len, ",threshold:%d", op->value); break;
+            case OP_GRAYSCALE: len += snprintf(text + len, size - len, ",gray"); break;
+            case OP_EQUALIZE: len += snprintf(text + len, size - len, ",equalize"); break;
+            case OP_FILTER: {
+                uint64_t hash = 14695981039346656037ULL;
+                const unsigned char *bytes = (const unsigned char *)op->kernel;
+                for (size_t b = 0; b < (size_t)op->kernelSize * op->kernelSize * sizeof(float); b++) {
+                    hash = (hash ^ bytes[b]) * 1099511628211ULL;
+                }
+                len += snprintf(text + len, size - len, ",filter:%d:%016llx", op->kernelSize, (unsigned long long)hash);
+                break;
+            }
+        }
+    }
+    return text;
+}
+
+// Contexte des passes parallèles. Pour la passe fusionnée, l'image est
+// découpée en bandes de lignes ; chaque bande lit ses lignes voisines
+// (halo) dans une copie faite avant la passe, puisque la bande d'à côté
+// peut déjà les avoir réécrites.
+typedef struct {
+    t_pipeline *p;
+    const t_pointStage *pre;
+    const t_op *conv;
+    const t_pointStage *post;
+    int bandRows;
+    unsigned char *halo; // par bande : offset lignes au-dessus puis offset lignes en dessous
+    unsigned char *rings; // par bande : fenêtre glissante de kernelSize lignes
+    size_t rowBytes;
+} t_passJob;
+
+static void pipeline_pointRows(void *ctx, int begin, int end) {
+    t_passJob *job = (t_passJob *)ctx;
+    t_bmp24 *img = job->p->img24;
+    for (int y = begin; y < end; y++) {
+        t_pixel *row = img->data[y];
+        for (int x = 0; x < img->width; x++) {
+            row[x] = point_apply24(job->pre, row[x]);
+        }
+    }
+}
+
+/**
+ * Passe unique appliquant une composition d'opérations ponctuelles
+ */
+static void pipeline_pointPass(t_pipeline *p, const t_pointStage *s) {
+    if (point_isIdentity(s)) return;
+    if (p->img8) {
+        bmp8_applyLut(p->img8, s->lutA); // palette seule si elle est en gris
+    } else {
+        t_passJob job = {p, s, NULL, NULL, 0, NULL, NULL, 0};
+        threadpool_parallelFor(0, p->img24->height, 0, pipeline_pointRows, &job);
+    }
+}
+
+// Adresse de la ligne y de l'image (octets bruts)
+static unsigned char *pipeline_row(t_pipeline *p, int y) {
+    if (p->img8) return p->img8->data + (size_t)y * p->img8->width;
+    return (unsigned char *)p->img24->data[y];
+}
+
+/**
+ * Ligne source y vue depuis une bande [y0, y1) : dans l'image si elle
+ * appartient à la bande, sinon dans la copie du halo
+ */
+static const unsigned char *pipeline_sourceRow(const t_passJob *job, int band, int y0, int y1, int y) {
+    int offset = job->conv->kernelSize / 2;
+    unsigned char *halo = job->halo + (size_t)band * 2 * offset * job->rowBytes;
+    if (y < y0) return halo + (size_t)(y - (y0 - offset)) * job->rowBytes;
+    if (y >= y1) return halo + (size_t)(offset + y - y1) * job->rowBytes;
+    return pipeline_row(job->p, y);
+}
+
+/**
+ * Passe fusionnée 8 bits sur une bande : opérations ponctuelles amont,
+ * convolution et opérations ponctuelles aval en un seul parcours. Les
+ * lignes sources (déjà transformées par l'amont) sont gardées dans une
+ * fenêtre glissante de kernelSize lignes, ce qui permet d'écrire le
+ * résultat sur place.
+ */
+static void pipeline_fusedBand8(t_passJob *job, int band, unsigned char *ring) {
+    t_bmp8 *img = job->p->img8;
+    const t_pointStage *pre = job->pre, *post = job->post;
+    int width = img->width, height = img->height;
+    int k = job->conv->kernelSize, offset = k / 2;
+    int y0 = band * job->bandRows;
+    int y1 = (y0 + job->bandRows < height) ? y0 + job->bandRows : height;
+
+    int next = (y0 - offset > 0) ? y0 - offset : 0;
+    for (int y = y0; y < y1; y++) {
+        // Charger les lignes nécessaires avant d'écraser la ligne y
+        while (next < height && next <= y + offset) {
+            const unsigned char *src = pipeline_sourceRow(job, band, y0, y1, next);
+            unsigned char *dst = ring + (size_t)(next % k) * width;
+            for (int x = 0; x < width; x++) dst[x] = pre->lutA[src[x]];
+            next++;
+        }
+
+        const unsigned char *cur = ring + (size_t)(y % k) * width;
+        unsigned char *out = img->data + (size_t)y * width;
+        int interiorRow = y >= offset && y < height - offset && width > 2 * offset;
+        for (int x = 0; x < width; x++) {
+            if (!interiorRow || x < offset || x >= width - offset) {
+                out[x] = post->lutA[cur[x]];
+                continue;
+            }
+            float sum = 0.0f;
+            for (int ky = -offset; ky <= offset; ky++) {
+                const unsigned char *line = ring + (size_t)((y + ky) % k) * width;
+                const float *coeffs = job->conv->kernel + (ky + offset) * k + offset;
+                for (int kx = -offset; kx <= offset; kx++) {
+                    sum += line[x + kx] * coeffs[kx];
+                }
+            }
+            int pixel = (int)roundf(sum);
+            if (pixel > 255) pixel = 255;
+            if (pixel < 0) pixel = 0;
+            out[x] = post->lutA[pixel];
+        }
+    }
+}
+
+/**
+ * Passe fusionnée 24 bits sur une bande, même principe que pipeline_fusedBand8
+ */
+static void pipeline_fusedBand24(t_passJob *job, int band, t_pixel *ring) {
+    t_bmp24 *img = job->p->img24;
+    const t_pointStage *pre = job->pre, *post = job->post;
+    int width = img->width, height = img->height;
+    int k = job->conv->kernelSize, offset = k / 2;
+    int y0 = band * job->bandRows;
+    int y1 = (y0 + job->bandRows < height) ? y0 + job->bandRows : height;
+
+    int next = (y0 - offset > 0) ? y0 - offset : 0;
+    for (int y = y0; y < y1; y++) {
+        while (next < height && next <= y + offset) {
+            const t_pixel *src = (const t_pixel *)pipeline_sourceRow(job, band, y0, y1, next);
+            t_pixel *dst = ring + (size_t)(next % k) * width;
+            for (int x = 0; x < width; x++) dst[x] = point_apply24(pre, src[x]);
+            next++;
+        }
+
+        const t_pixel *cur = ring + (size_t)(y % k) * width;
+        t_pixel *out = img->data[y];
+        int interiorRow = y >= offset && y < height - offset && width > 2 * offset;
+        for (int x = 0; x < width; x++) {
+            if (!interiorRow || x < offset || x >= width - offset) {
+                out[x] = point_apply24(post, cur[x]);
+                continue;
+            }
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            for (int ky = -offset; ky <= offset; ky++) {
+                const t_pixel *line = ring + (size_t)((y + ky) % k) * width;
+                const float *coeffs = job->conv->kernel + (ky + offset) * k + offset;
+                for (int kx = -offset; kx <= offset; kx++) {
+                    t_pixel q = line[x + kx];
+                    r += q.red * coeffs[kx];
+                    g += q.green * coeffs[kx];
+                    b += q.blue * coeffs[kx];
+                }
+            }
+            t_pixel result;
+            result.red = (uint8_t)fminf(fmaxf(roundf(r), 0), 255);
+            result.green = (uint8_t)fminf(fmaxf(roundf(g), 0), 255);
+            result.blue = (uint8_t)fminf(fmaxf(roundf(b), 0), 255);
+            out[x] = point_apply24(post, result);
+        }
+    }
+}
+
+static void pipeline_fusedTask(void *ctx, int begin, int end) {
+    t_passJob *job = (t_passJob *)ctx;
+    for (int band = begin; band < end; band++) {
+        unsigned char *ring = job->rings + (size_t)band * job->conv->kernelSize * job->rowBytes;
+        if (job->p->img8) pipeline_fusedBand8(job, band, ring);
+        else pipeline_fusedBand24(job, band, (t_pixel *)ring);
+    }
+}
+
+/**
+ * Passe fusionnée (amont, convolution, aval), parallélisée par bandes
+ * @return 0 si succès, -1 si la mémoire manque (image inchangée)
+ */
+static int pipeline_fusedPass(t_pipeline *p, const t_pointStage *pre, const t_op *conv, const t_pointStage *post) {
+    int height = p->img8 ? (int)p->img8->height : p->img24->height;
+    size_t rowBytes = p->img8 ? p->img8->width : p->img24->width * sizeof(t_pixel);
+    int offset = conv->kernelSize / 2;
+
+    // Des bandes d'au moins 4 fois le noyau pour que le halo reste marginal
+    int bandRows = height / (4 * threadpool_threadCount());
+    if (bandRows < 4 * conv->kernelSize) bandRows = 4 * conv->kernelSize;
+    int nBands = (height + bandRows - 1) / bandRows;
+
+    // Tout est alloué avant la passe : une bande ne peut pas échouer à
+    // mi-chemin après que ses voisines ont déjà écrit leurs lignes
+    unsigned char *halo = (unsigned char *)malloc((size_t)nBands * (2 * offset + conv->kernelSize) * rowBytes);
+    if (!halo) return -1;
+    unsigned char *rings = halo + (size_t)nBands * 2 * offset * rowBytes;
+    for (int band = 0; band < nBands; band++) {
+        int y0 = band * bandRows;
+        int y1 = (y0 + bandRows < height) ? y0 + bandRows : height;
+        unsigned char *dst = halo + (size_t)band * 2 * offset * rowBytes;
+        for (int i = 0; i < offset; i++) {
+            if (y0 - offset + i >= 0) memcpy(dst + i * rowBytes, pipeline_row(p, y0 - offset + i), rowBytes);
+            if (y1 + i < height) memcpy(dst + (offset + i) * rowBytes, pipeline_row(p, y1 + i), rowBytes);
+        }
+    }
+
+    t_passJob job = {p, pre, conv, post, bandRows, halo, rings, rowBytes};
+    threadpool_parallelFor(0, nBands, 1, pipeline_fusedTask, &job);
+    free(halo);
+    return 0;
+}
+
+/**
+ * Applique une convolution seule via les fonctions classiques (chemin FFT
+ * pour les grands noyaux, ou repli si la passe fusionnée est impossible)
+ */
+static void pipeline_eagerFilter(t_pipeline *p, const t_op *conv) {
+    int k = conv->kernelSize;
+    float **kernel = (float **)malloc(k * sizeof(float *));
+    if (!kernel) return;
+    for (int i = 0; i < k; i++) kernel[i] = conv->kernel + i * k;
+    if (p->img8) bmp8_applyFilter(p->img8, kernel, k);
+    else bmp24_applyFilter(p->img24, kernel, k);
+    free(kernel);
+}
+
+/**
+ * Exécute les opérations enregistrées puis vide le pipeline.
+ * Les opérations ponctuelles consécutives sont composées en une table,
+ * fusionnées avec la convolution qui les suit ou les précède, et les
+ * compositions neutres (ex : deux négatifs) ne coûtent aucune passe.
+ * L'égalisation, qui dépend de l'histogramme global, reste une barrière.
+ * @param p Pipeline à exécuter
+ */
+void pipeline_execute(t_pipeline *p) {
+    if (!p) return;
+    PROFILE_BEGIN(pipeline_execute);
+    int is24 = p->img24 != NULL;
+    t_pointStage pre, post;
+    point_reset(&pre);
+
+    int i = 0;
+    while (i < p->count) {
+        const t_op *op = &p->ops[i];
+        if (op_isPoint(op)) {
+            point_append(&pre, op, is24);
+            i++;
+            continue;
+        }
+
+        if (op->type == OP_EQUALIZE) {
+            pipeline_pointPass(p, &pre);
+            point_reset(&pre);
+            if (p->img8) bmp8_equalizeHistogram(p->img8);
+            else bmp24_equalizeHistogram(p->img24);
+            i++;
+            continue;
+        }
+
+        // Convolution : on rattache les opérations ponctuelles qui suivent
+        const t_op *conv = op;
+        point_reset(&post);
+        for (i++; i < p->count && op_isPoint(&p->ops[i]); i++) {
+            point_append(&post, &p->ops[i], is24);
+        }
+
+        int done = -1;
+        if (conv->kernelSize < FFT_CROSSOVER_KERNEL_SIZE) {
+            // La convolution lit des intensités : palette reportée dans les pixels
+            if (p->img8) bmp8_applyPalette(p->img8);
+            done = pipeline_fusedPass(p, &pre, conv, &post);
+        }
+        if (done != 0) {
+            pipeline_pointPass(p, &pre);
+            pipeline_eagerFilter(p, conv);
+            pipeline_pointPass(p, &post);
+        }
+        point_reset(&pre);
+    }
+    pipeline_pointPass(p, &pre);
+
+    PROFILE_END(pipeline_execute, is24 ? (size_t)p->img24->width * p->img24->height : p->img8->dataSize);
+    pipeline_clear(p);
+}
+
+/**
+ * Exécute les opérations en attente puis sauvegarde l'image
+ * @param p Pipeline
+ * @param filename Chemin du fichier de sortie
+ * @return 0 si succès, -1 si le fichier n'a pas pu être écrit
+ */
+int pipeline_save(t_pipeline *p, const char *filename) {
+    if (!p) return -1;
+    pipeline_execute(p);
+    if (p->img8) return bmp8_saveImage(filename, p->img8);
+    return bmp24_saveImage(p->img24, filename);
+}
@@ -0,0 +1,52 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "bmp8.h"
+#include "bmp24.h"
+
+// Opérations enregistrables dans un pipeline différé
+typedef enum {
+    OP_NEGATIVE,
+    OP_BRIGHTNESS,
+    OP_THRESHOLD,
+    OP_GRAYSCALE,
+    OP_FILTER,
+    OP_EQUALIZE
+} t_opType;
+
+typedef struct {
+    t_opType type;
+    int value;       // luminosité ou seuil
+    int kernelSize;  // OP_FILTER uniquement
+    float *kernel;   // copie du noyau, kernelSize * kernelSize valeurs
+} t_op;
+
+// Pipeline différé : les opérations sont enregistrées sur l'image puis
+// exécutées d'un bloc, avec fusion des opérations ponctuelles dans les
+// convolutions voisines. Une seule des deux images est renseignée.
+typedef struct {
+    t_bmp8 *img8;
+    t_bmp24 *img24;
+    t_op *ops;
+    int count;
+    int capacity;
+} t_pipeline;
+
+t_pipeline *pipeline_create8(t_bmp8 *img);
+t_pipeline *pipeline_create24(t_bmp24 *img);
+void pipeline_free(t_pipeline *p);
+
+void pipeline_negative(t_pipeline *p);
+void pipeline_brightness(t_pipeline *p, int value);
+void pipeline_threshold(t_pipeline *p, int threshold);
+void pipeline_grayscale(t_pipeline *p);
+void pipeline_filter(t_pipeline *p, float **kernel, int kernelSize);
+void pipeline_equalize(t_pipeline *p);
+int pipeline_parse(t_pipeline *p, const char *chain);
+
+void pipeline_execute(t_pipeline *p);
+void pipeline_clear(t_pipeline *p);
+char *pipeline_describe(const t_pipeline *p);
+int pipeline_save(t_pipeline *p, const char *filename);
+
+#endif // PIPELINE_H
@@ -0,0 +1,303 @@
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define PROFILE_MAX_OPS 64
+#define PROFILE_MAX_EVENTS (1 << 20) // par thread, pour borner la mémoire
+
+// Compteurs cumulés d'une opération
+typedef struct {
+    const char *name;
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t pixels;
+} t_profileOp;
+
+// Événement individuel pour l'export Chrome trace
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    uint64_t pixels;
+} t_profileEvent;
+
+// Compteurs d'un thread, chaînés pour l'agrégation
+typedef struct t_profileThread {
+    int id;
+    uint64_t firstSeen;
+    uint64_t lastSeen;
+    uint64_t busyNs;    // temps passé dans des opérations de premier niveau
+    int depth;          // imbrication des opérations en cours
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+    t_profileOp ops[PROFILE_MAX_OPS];
+    int nOps;
+    t_profileEvent *events;
+    int nEvents;
+    int capEvents;
+    struct t_profileThread *next;
+} t_profileThread;
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static t_profileThread *profile_threads = NULL;
+// Compteurs des threads terminés (serveur : un thread par connexion),
+// dont les événements ont été libérés
+static t_profileThread profile_retired = {.id = -1};
+static int profile_nRetired = 0;
+static pthread_key_t profile_key;
+static pthread_once_t profile_keyOnce = PTHREAD_ONCE_INIT;
+static int profile_nextId = 0;
+static uint64_t profile_origin = 0;
+static _Thread_local t_profileThread *profile_self = NULL;
+
+static uint64_t profile_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Cumule les opérations ops dans total (au plus PROFILE_MAX_OPS entrées)
+static void profile_mergeOps(t_profileOp *total, int *nTotal, const t_profileOp *ops, int nOps) {
+    for (int i = 0; i < nOps; i++) {
+        int j = 0;
+        while (j < *nTotal && strcmp(total[j].name, ops[i].name) != 0) j++;
+        if (j == *nTotal) {
+            if (*nTotal == PROFILE_MAX_OPS) continue;
+            total[(*nTotal)++] = (t_profileOp){ops[i].name, 0, 0, 0, 0};
+        }
+        total[j].calls += ops[i].calls;
+        total[j].totalNs += ops[i].totalNs;
+        total[j].pixels += ops[i].pixels;
+        if (ops[i].maxNs > total[j].maxNs) total[j].maxNs = ops[i].maxNs;
+    }
+}
+
+/**
+ * Destructeur appelé à la fin d'un thread : ses compteurs rejoignent
+ * l'agrégat des threads terminés, sa mémoire est libérée
+ */
+static void profile_retire(void *value) {
+    t_profileThread *t = (t_profileThread *)value;
+    pthread_mutex_lock(&profile_lock);
+    t_profileThread **link = &profile_threads;
+    while (*link && *link != t) link = &(*link)->next;
+    if (*link) *link = t->next;
+
+    profile_retired.busyNs += t->busyNs;
+    profile_retired.bytesRead += t->bytesRead;
+    profile_retired.bytesWritten += t->bytesWritten;
+    profile_retired.allocations += t->allocations;
+    profile_retired.allocatedBytes += t->allocatedBytes;
+    profile_mergeOps(profile_retired.ops, &profile_retired.nOps, t->ops, t->nOps);
+    profile_nRetired++;
+    pthread_mutex_unlock(&profile_lock);
+
+    free(t->events);
+    free(t);
+}
+
+static void profile_createKey(void) {
+    pthread_key_create(&profile_key, profile_retire);
+}
+
+/**
+ * Retourne les compteurs du thread courant, créés au premier appel
+ * (seul moment où le verrou global est pris)
+ */
+static t_profileThread *profile_thread(void) {
+    if (profile_self) return profile_self;
+
+    t_profileThread *t = (t_profileThread *)calloc(1, sizeof(t_profileThread));
+    if (!t) return NULL;
+    t->firstSeen = profile_now();
+    t->lastSeen = t->firstSeen;
+    pthread_once(&profile_keyOnce, profile_createKey);
+    if (pthread_setspecific(profile_key, t) != 0) {
+        free(t);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&profile_lock);
+    if (!profile_origin) profile_origin = t->firstSeen;
+    t->id = profile_nextId++;
+    t->next = profile_threads;
+    profile_threads = t;
+    pthread_mutex_unlock(&profile_lock);
+
+    profile_self = t;
+    return t;
+}
+
+/**
+ * Début d'une opération mesurée
+ * @return Horodatage de début (ns)
+ */
+uint64_t profile_begin(void) {
+    t_profileThread *t = profile_thread();
+    if (t) t->depth++;
+    return profile_now();
+}
+
+/**
+ * Fin d'une opération mesurée
+ * @param op Nom de l'opération (chaîne statique)
+ * @param start Horodatage retourné par profile_begin
+ * @param pixels Nombre de pixels traités
+ */
+void profile_end(const char *op, uint64_t start, uint64_t pixels) {
+    uint64_t end = profile_now();
+    t_profileThread *t = profile_thread();
+    if (!t) return;
+
+    uint64_t duration = end - start;
+    if (--t->depth == 0) t->busyNs += duration;
+    t->lastSeen = end;
+
+    t_profileOp *entry = NULL;
+    for (int i = 0; i < t->nOps; i++) {
+        if (t->ops[i].name == op || strcmp(t->ops[i].name, op) == 0) {
+            entry = &t->ops[i];
+            break;
+        }
+    }
+    if (!entry && t->nOps < PROFILE_MAX_OPS) {
+        entry = &t->ops[t->nOps++];
+        entry->name = op;
+    }
+    if (entry) {
+        entry->calls++;
+        entry->totalNs += duration;
+        if (duration > entry->maxNs) entry->maxNs = duration;
+        entry->pixels += pixels;
+    }
+
+    if (t->nEvents == t->capEvents && t->capEvents < PROFILE_MAX_EVENTS) {
+        int capacity = t->capEvents ? t->capEvents * 2 : 256;
+        t_profileEvent *events = (t_profileEvent *)realloc(t->events, capacity * sizeof(t_profileEvent));
+        if (events) {
+            t->events = events;
+            t->capEvents = capacity;
+        }
+    }
+    if (t->nEvents < t->capEvents) {
+        t->events[t->nEvents++] = (t_profileEvent){op, start, duration, pixels};
+    }
+}
+
+void profile_addBytesRead(uint64_t bytes) {
+    t_profileThread *t = profile_thread();
+    if (t) t->bytesRead += bytes;
+}
+
+void profile_addBytesWritten(uint64_t bytes) {
+    t_profileThread *t = profile_thread();
+    if (t) t->bytesWritten += bytes;
+}
+
+void profile_addAlloc(uint64_t bytes) {
+    t_profileThread *t = profile_thread();
+    if (t) {
+        t->allocations++;
+        t->allocatedBytes += bytes;
+    }
+}
+
+/**
+ * Exporte les compteurs agrégés par opération et par thread au format JSON
+ * @param filename Fichier de sortie
+ * @return 0 si succès, -1 sinon
+ */
+int profile_dumpJson(const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Erreur : impossible d'écrire dans %s\n", filename);
+        return -1;
+    }
+
+    pthread_mutex_lock(&profile_lock);
+
+    // Agrégation des opérations de tous les threads
+    t_profileOp total[PROFILE_MAX_OPS];
+    int nTotal = 0;
+    uint64_t bytesRead = profile_retired.bytesRead, bytesWritten = profile_retired.bytesWritten;
+    uint64_t allocations = profile_retired.allocations, allocatedBytes = profile_retired.allocatedBytes;
+    profile_mergeOps(total, &nTotal, profile_retired.ops, profile_retired.nOps);
+    for (t_profileThread *t = profile_threads; t; t = t->next) {
+        bytesRead += t->bytesRead;
+        bytesWritten += t->bytesWritten;
+        allocations += t->allocations;
+        allocatedBytes += t->allocatedBytes;
+        profile_mergeOps(total, &nTotal, t->ops, t->nOps);
+    }
+
+    fprintf(file, "{\n  \"bytesRead\": %llu,\n  \"bytesWritten\": %llu,\n",
+            (unsigned long long)bytesRead, (unsigned long long)bytesWritten);
+    fprintf(file, "  \"allocations\": %llu,\n  \"allocatedBytes\": %llu,\n",
+            (unsigned long long)allocations, (unsigned long long)allocatedBytes);
+
+    fprintf(file, "  \"operations\": [");
+    for (int i = 0; i < nTotal; i++) {
+        double ms = total[i].totalNs / 1e6;
+        double mpixPerSec = total[i].totalNs ? total[i].pixels * 1e3 / total[i].totalNs : 0.0;
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"calls\": %llu, \"totalMs\": %.3f, \"maxMs\": %.3f, "
+                      "\"pixels\": %llu, \"mpixPerSec\": %.2f}",
+                i ? "," : "", total[i].name, (unsigned long long)total[i].calls, ms, total[i].maxNs / 1e6,
+                (unsigned long long)total[i].pixels, mpixPerSec);
+    }
+    fprintf(file, "\n  ],\n");
+
+    // Utilisation : part du temps de vie observé du thread passée en opération
+    fprintf(file, "  \"threads\": [");
+    int first = 1;
+    for (t_profileThread *t = profile_threads; t; t = t->next) {
+        uint64_t span = t->lastSeen - t->firstSeen;
+        fprintf(file, "%s\n    {\"id\": %d, \"busyMs\": %.3f, \"spanMs\": %.3f, \"utilisation\": %.3f}",
+                first ? "" : ",", t->id, t->busyNs / 1e6, span / 1e6, span ? (double)t->busyNs / span : 0.0);
+        first = 0;
+    }
+    fprintf(file, "\n  ],\n  \"retiredThreads\": %d,\n  \"retiredBusyMs\": %.3f\n}\n",
+            profile_nRetired, profile_retired.busyNs / 1e6);
+
+    pthread_mutex_unlock(&profile_lock);
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Exporte les événements des threads encore en vie au format Chrome trace
+ * (événements "X")
+ * @param filename Fichier de sortie
+ * @return 0 si succès, -1 sinon
+ */
+int profile_dumpChromeTrace(const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Erreur : impossible d'écrire dans %s\n", filename);
+        return -1;
+    }
+
+    pthread_mutex_lock(&profile_lock);
+    fprintf(file, "{\"traceEvents\": [");
+    int first = 1;
+    for (t_profileThread *t = profile_threads; t; t = t->next) {
+        for (int i = 0; i < t->nEvents; i++) {
+            const t_profileEvent *e = &t->events[i];
+            fprintf(file, "%s\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                          "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"pixels\": %llu}}",
+                    first ? "" : ",", e->name, t->id, (e->start - profile_origin) / 1e3, e->duration / 1e3,
+                    (unsigned long long)e->pixels);
+            first = 0;
+        }
+    }
+    fprintf(file, "\n], \"displayTimeUnit\": \"ms\"}\n");
+    pthread_mutex_unlock(&profile_lock);
+
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// Instrumentation des chemins critiques, activée par l'option CMake
+// PROJETC_PROFILING. Sans l'option, les macros ne génèrent aucun code.
+// Les compteurs sont locaux à chaque thread (aucune synchronisation sur le
+// chemin chaud) et agrégés uniquement au moment de l'export. À la fin d'un
+// thread, ses compteurs rejoignent un agrégat commun et ses événements sont
+// libérés : la trace ne garde que les threads encore en vie.
+
+#define PROFILE_JSON_FILE "profile.json"
+#define PROFILE_TRACE_FILE "trace.json"
+
+#ifdef PROJETC_PROFILING
+
+// Mesure une opération : PROFILE_BEGIN(nom) ... PROFILE_END(nom, pixels)
+#define PROFILE_BEGIN(op) uint64_t profile_start_##op = profile_begin()
+#define PROFILE_END(op, pixels) profile_end(#op, profile_start_##op, (uint64_t)(pixels))
+#define PROFILE_BYTES_READ(n) profile_addBytesRead((uint64_t)(n))
+#define PROFILE_BYTES_WRITTEN(n) profile_addBytesWritten((uint64_t)(n))
+#define PROFILE_ALLOC(n) profile_addAlloc((uint64_t)(n))
+
+#else
+
+#define PROFILE_BEGIN(op) ((void)0)
+#define PROFILE_END(op, pixels) ((void)0)
+#define PROFILE_BYTES_READ(n) ((void)0)
+#define PROFILE_BYTES_WRITTEN(n) ((void)0)
+#define PROFILE_ALLOC(n) ((void)0)
+
+#endif
+
+uint64_t profile_begin(void);
+void profile_end(const char *op, uint64_t start, uint64_t pixels);
+void profile_addBytesRead(uint64_t bytes);
+void profile_addBytesWritten(uint64_t bytes);
+void profile_addAlloc(uint64_t bytes);
+
+// Export des compteurs agrégés (JSON) ou des événements (format Chrome trace,
+// lisible dans chrome://tracing ou Perfetto). Retourne 0 si succès.
+int profile_dumpJson(const char *filename);
+int profile_dumpChromeTrace(const char *filename);
+
+#endif // PROFILE_H
@@ -0,0 +1,385 @@
+#include "quantize.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <pthread.h>
+#include <string.h>
+
+// Précision de l'histogramme et de la grille de recherche : 5 bits par canal
+#define QUANTIZE_BITS 5
+#define QUANTIZE_SIDE (1 << QUANTIZE_BITS)
+#define QUANTIZE_CELLS (QUANTIZE_SIDE * QUANTIZE_SIDE * QUANTIZE_SIDE)
+#define QUANTIZE_SHIFT (8 - QUANTIZE_BITS)
+
+#define QUANTIZE_INDEX(r, g, b) \
+    ((((r) >> QUANTIZE_SHIFT) << (2 * QUANTIZE_BITS)) | (((g) >> QUANTIZE_SHIFT) << QUANTIZE_BITS) | ((b) >> QUANTIZE_SHIFT))
+
+// Matrice de Bayer 8x8 (seuils 0 à 63) pour le tramage ordonné
+static const unsigned char bayer8[8][8] = {
+    { 0, 32,  8, 40,  2, 34, 10, 42},
+    {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44,  4, 36, 14, 46,  6, 38},
+    {60, 28, 52, 20, 62, 30, 54, 22},
+    { 3, 35, 11, 43,  1, 33,  9, 41},
+    {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47,  7, 39, 13, 45,  5, 37},
+    {63, 31, 55, 23, 61, 29, 53, 21}
+};
+
+// Boîte de la coupe médiane, bornes incluses dans l'espace 5 bits
+typedef struct {
+    int lo[3];
+    int hi[3];
+    long long count;
+} t_colorBox;
+
+// Contexte partagé par les tâches de quantification
+typedef struct {
+    t_bmp24 *img;
+    t_bmp8 *out;
+    int *histogram;            // QUANTIZE_CELLS entrées
+    unsigned char *grid;       // index de palette par cellule
+    unsigned char palette[QUANTIZE_MAX_COLORS][3]; // R, G, B
+    int nPalette;
+    int spread;                // amplitude du tramage ordonné
+    pthread_mutex_t lock;
+} t_quantizeJob;
+
+static int clampByte(int v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static long long box_bin(const int *histogram, int r, int g, int b) {
+    return histogram[(r << (2 * QUANTIZE_BITS)) | (g << QUANTIZE_BITS) | b];
+}
+
+/**
+ * Resserre les bornes d'une boîte sur les cellules non vides et recompte
+ * sa population
+ */
+static void box_shrink(const int *histogram, t_colorBox *box) {
+    int lo[3] = {QUANTIZE_SIDE, QUANTIZE_SIDE, QUANTIZE_SIDE};
+    int hi[3] = {-1, -1, -1};
+    box->count = 0;
+    for (int r = box->lo[0]; r <= box->hi[0]; r++) {
+        for (int g = box->lo[1]; g <= box->hi[1]; g++) {
+            for (int b = box->lo[2]; b <= box->hi[2]; b++) {
+                long long n = box_bin(histogram, r, g, b);
+                if (!n) continue;
+                box->count += n;
+                int v[3] = {r, g, b};
+                for (int c = 0; c < 3; c++) {
+                    if (v[c] < lo[c]) lo[c] = v[c];
+                    if (v[c] > hi[c]) hi[c] = v[c];
+                }
+            }
+        }
+    }
+    if (box->count) {
+        memcpy(box->lo, lo, sizeof(lo));
+        memcpy(box->hi, hi, sizeof(hi));
+    }
+}
+
+/**
+ * Coupe une boîte en deux à la médiane de sa population, le long de son
+ * axe le plus long
+ * @return 0 si la coupe a eu lieu, -1 si la boîte ne contient qu'une cellule
+ */
+static int box_split(const int *histogram, t_colorBox *box, t_colorBox *other) {
+    int axis = 0;
+    for (int c = 1; c < 3; c++) {
+        if (box->hi[c] - box->lo[c] > box->hi[axis] - box->lo[axis]) axis = c;
+    }
+    if (box->hi[axis] == box->lo[axis]) return -1;
+
+    // Population de chaque tranche le long de l'axe choisi
+    long long slices[QUANTIZE_SIDE] = {0};
+    for (int r = box->lo[0]; r <= box->hi[0]; r++) {
+        for (int g = box->lo[1]; g <= box->hi[1]; g++) {
+            for (int b = box->lo[2]; b <= box->hi[2]; b++) {
+                int v[3] = {r, g, b};
+                slices[v[axis]] += box_bin(histogram, r, g, b);
+            }
+        }
+    }
+
+    long long half = box->count / 2;
+    long long sum = 0;
+    int cut = box->lo[axis];
+    for (; cut < box->hi[axis] - 1; cut++) {
+        sum += slices[cut];
+        if (sum >= half) break;
+    }
+
+    *other = *box;
+    box->hi[axis] = cut;
+    other->lo[axis] = cut + 1;
+    box_shrink(histogram, box);
+    box_shrink(histogram, other);
+    return 0;
+}
+
+/**
+ * Construit la palette par coupe médiane. La première moitié des coupes
+ * porte sur les boîtes les plus peuplées, la seconde sur le produit
+ * population x volume, pour ne pas négliger les zones de couleur rares
+ * mais étendues.
+ */
+static void quantize_medianCut(t_quantizeJob *job, int nColors) {
+    t_colorBox boxes[QUANTIZE_MAX_COLORS];
+    int nBoxes = 1;
+    boxes[0].lo[0] = boxes[0].lo[1] = boxes[0].lo[2] = 0;
+    boxes[0].hi[0] = boxes[0].hi[1] = boxes[0].hi[2] = QUANTIZE_SIDE - 1;
+    box_shrink(job->histogram, &boxes[0]);
+
+    while (nBoxes < nColors) {
+        int best = -1;
+        long long bestScore = 0;
+        for (int i = 0; i < nBoxes; i++) {
+            const t_colorBox *box = &boxes[i];
+            if (box->lo[0] == box->hi[0] && box->lo[1] == box->hi[1] && box->lo[2] == box->hi[2]) continue;
+            long long score = box->count;
+            if (nBoxes >= nColors / 2) {
+                score *= (long long)(box->hi[0] - box->lo[0] + 1) * (box->hi[1] - box->lo[1] + 1) * (box->hi[2] - box->lo[2] + 1);
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                best = i;
+            }
+        }
+        if (best < 0 || box_split(job->histogram, &boxes[best], &boxes[nBoxes]) != 0) break;
+        nBoxes++;
+    }
+
+    // Couleur d'une boîte : moyenne pondérée des centres de ses cellules
+    for (int i = 0; i < nBoxes; i++) {
+        long long sum[3] = {0, 0, 0};
+        long long count = 0;
+        for (int r = boxes[i].lo[0]; r <= boxes[i].hi[0]; r++) {
+            for (int g = boxes[i].lo[1]; g <= boxes[i].hi[1]; g++) {
+                for (int b = boxes[i].lo[2]; b <= boxes[i].hi[2]; b++) {
+                    long long n = box_bin(job->histogram, r, g, b);
+                    sum[0] += n * ((r << QUANTIZE_SHIFT) + (1 << (QUANTIZE_SHIFT - 1)));
+                    sum[1] += n * ((g << QUANTIZE_SHIFT) + (1 << (QUANTIZE_SHIFT - 1)));
+                    sum[2] += n * ((b << QUANTIZE_SHIFT) + (1 << (QUANTIZE_SHIFT - 1)));
+                    count += n;
+                }
+            }
+        }
+        for (int c = 0; c < 3; c++) {
+            job->palette[i][c] = (unsigned char)(count ? (sum[c] + count / 2) / count : 0);
+        }
+    }
+    job->nPalette = nBoxes;
+}
+
+// Histogramme 5 bits des lignes [begin, end), fusionné sous verrou
+static void quantize_histogramRows(void *ctx, int begin, int end) {
+    t_quantizeJob *job = (t_quantizeJob *)ctx;
+    int *local = (int *)calloc(QUANTIZE_CELLS, sizeof(int));
+    if (!local) {
+        // Repli sans tampon local : comptage direct sous verrou
+        pthread_mutex_lock(&job->lock);
+        for (int y = begin; y < end; y++) {
+            const t_pixel *row = job->img->data[y];
+            for (int x = 0; x < job->img->width; x++) {
+                job->histogram[QUANTIZE_INDEX(row[x].red, row[x].green, row[x].blue)]++;
+            }
+        }
+        pthread_mutex_unlock(&job->lock);
+        return;
+    }
+    for (int y = begin; y < end; y++) {
+        const t_pixel *row = job->img->data[y];
+        for (int x = 0; x < job->img->width; x++) {
+            local[QUANTIZE_INDEX(row[x].red, row[x].green, row[x].blue)]++;
+        }
+    }
+    pthread_mutex_lock(&job->lock);
+    for (int i = 0; i < QUANTIZE_CELLS; i++) {
+        job->histogram[i] += local[i];
+    }
+    pthread_mutex_unlock(&job->lock);
+    free(local);
+}
+
+// Grille de recherche : couleur de palette la plus proche du centre de
+// chaque cellule, pour les plans rouges [begin, end)
+static void quantize_gridTask(void *ctx, int begin, int end) {
+    t_quantizeJob *job = (t_quantizeJob *)ctx;
+    int half = 1 << (QUANTIZE_SHIFT - 1);
+    for (int r = begin; r < end; r++) {
+        int cr = (r << QUANTIZE_SHIFT) + half;
+        for (int g = 0; g < QUANTIZE_SIDE; g++) {
+            int cg = (g << QUANTIZE_SHIFT) + half;
+            for (int b = 0; b < QUANTIZE_SIDE; b++) {
+                int cb = (b << QUANTIZE_SHIFT) + half;
+                int best = 0;
+                int bestDist = 3 * 256 * 256;
+                for (int i = 0; i < job->nPalette; i++) {
+                    int dr = cr - job->palette[i][0];
+                    int dg = cg - job->palette[i][1];
+                    int db = cb - job->palette[i][2];
+                    int dist = dr * dr + dg * dg + db * db;
+                    if (dist < bestDist) {
+                        bestDist = dist;
+                        best = i;
+                    }
+                }
+                job->grid[(r << (2 * QUANTIZE_BITS)) | (g << QUANTIZE_BITS) | b] = (unsigned char)best;
+            }
+        }
+    }
+}
+
+// Affectation directe des lignes [begin, end)
+static void quantize_mapRows(void *ctx, int begin, int end) {
+    t_quantizeJob *job = (t_quantizeJob *)ctx;
+    int width = job->img->width;
+    for (int y = begin; y < end; y++) {
+        const t_pixel *src = job->img->data[y];
+        unsigned char *dst = job->out->data + (size_t)(job->img->height - 1 - y) * width;
+        for (int x = 0; x < width; x++) {
+            dst[x] = job->grid[QUANTIZE_INDEX(src[x].red, src[x].green, src[x].blue)];
+        }
+    }
+}
+
+// Affectation avec tramage ordonné des lignes [begin, end) : le seuil ne
+// dépend que de la position du pixel, les bandes restent indépendantes
+static void quantize_orderedRows(void *ctx, int begin, int end) {
+    t_quantizeJob *job = (t_quantizeJob *)ctx;
+    int width = job->img->width;
+    for (int y = begin; y < end; y++) {
+        const t_pixel *src = job->img->data[y];
+        unsigned char *dst = job->out->data + (size_t)(job->img->height - 1 - y) * width;
+        for (int x = 0; x < width; x++) {
+            int offset = ((2 * bayer8[y & 7][x & 7] - 63) * job->spread) / 128;
+            int r = clampByte(src[x].red + offset);
+            int g = clampByte(src[x].green + offset);
+            int b = clampByte(src[x].blue + offset);
+            dst[x] = job->grid[QUANTIZE_INDEX(r, g, b)];
+        }
+    }
+}
+
+/**
+ * Affectation avec diffusion d'erreur de Floyd-Steinberg. Chaque pixel
+ * dépend de ses voisins déjà traités : ce parcours reste séquentiel.
+ * @return 0 si succès, -1 en cas d'échec d'allocation
+ */
+static int quantize_floydSteinberg(t_quantizeJob *job) {
+    int width = job->img->width;
+    // Erreurs accumulées (x16) de la ligne courante et de la suivante,
+    // avec une case de marge de chaque côté
+    int *errors = (int *)calloc((size_t)(width + 2) * 3 * 2, sizeof(int));
+    if (!errors) return -1;
+    int *current = errors;
+    int *next = errors + (size_t)(width + 2) * 3;
+
+    for (int y = 0; y < job->img->height; y++) {
+        const t_pixel *src = job->img->data[y];
+        unsigned char *dst = job->out->data + (size_t)(job->img->height - 1 - y) * width;
+        memset(next, 0, (size_t)(width + 2) * 3 * sizeof(int));
+        for (int x = 0; x < width; x++) {
+            int *e = current + (x + 1) * 3;
+            int value[3] = {
+                clampByte(src[x].red + (e[0] + 8) / 16),
+                clampByte(src[x].green + (e[1] + 8) / 16),
+                clampByte(src[x].blue + (e[2] + 8) / 16)
+            };
+            int index = job->grid[QUANTIZE_INDEX(value[0], value[1], value[2])];
+            dst[x] = (unsigned char)index;
+            for (int c = 0; c < 3; c++) {
+                int err = value[c] - job->palette[index][c];
+                e[3 + c] += err * 7;
+                next[x * 3 + c] += err * 3;
+                next[(x + 1) * 3 + c] += err * 5;
+                next[(x + 2) * 3 + c] += err;
+            }
+        }
+        int *tmp = current;
+        current = next;
+        next = tmp;
+    }
+
+    free(errors);
+    return 0;
+}
+
+/**
+ * Quantifie une image 24 bits en image 8 bits indexée
+ * @param img Image source (inchangée)
+ * @param nColors Nombre maximal de couleurs de la palette (2 à 256)
+ * @param dither Tramage appliqué lors de l'affectation
+ * @return Nouvelle image 8 bits avec sa palette, NULL en cas d'échec
+ */
+t_bmp8 *quantize_image(t_bmp24 *img, int nColors, t_dither dither) {
+    if (!img || !img->data) return NULL;
+    if (nColors < 2) nColors = 2;
+    if (nColors > QUANTIZE_MAX_COLORS) nColors = QUANTIZE_MAX_COLORS;
+    PROFILE_BEGIN(quantize_image);
+
+    t_quantizeJob *job = (t_quantizeJob *)calloc(1, sizeof(t_quantizeJob));
+    t_bmp8 *out = bmp8_allocate(img->width, img->height);
+    if (job) {
+        job->histogram = (int *)calloc(QUANTIZE_CELLS, sizeof(int));
+        job->grid = (unsigned char *)malloc(QUANTIZE_CELLS);
+    }
+    if (!job || !out || !job->histogram || !job->grid) {
+        printf("Erreur : Allocation memoire echouee pour la quantification.\n");
+        if (job) {
+            free(job->histogram);
+            free(job->grid);
+            free(job);
+        }
+        bmp8_free(out);
+        PROFILE_END(quantize_image, 0);
+        return NULL;
+    }
+    PROFILE_ALLOC(QUANTIZE_CELLS * (sizeof(int) + 1));
+    job->img = img;
+    job->out = out;
+    pthread_mutex_init(&job->lock, NULL);
+
+    // 1. Histogramme, 2. palette, 3. grille de recherche
+    threadpool_parallelFor(0, img->height, 0, quantize_histogramRows, job);
+    quantize_medianCut(job, nColors);
+    threadpool_parallelFor(0, QUANTIZE_SIDE, 1, quantize_gridTask, job);
+
+    // 4. Affectation des pixels
+    int failed = 0;
+    if (dither == DITHER_FLOYD_STEINBERG) {
+        failed = quantize_floydSteinberg(job);
+    } else if (dither == DITHER_ORDERED) {
+        // Amplitude : écart moyen entre deux niveaux de la palette par canal
+        int levels = 1;
+        while (levels * levels * levels < job->nPalette) levels++;
+        job->spread = 256 / levels;
+        threadpool_parallelFor(0, img->height, 0, quantize_orderedRows, job);
+    } else {
+        threadpool_parallelFor(0, img->height, 0, quantize_mapRows, job);
+    }
+
+    // Palette BMP : B, G, R, réservé ; les entrées inutilisées restent noires
+    memset(out->colorTable, 0, sizeof(out->colorTable));
+    for (int i = 0; i < job->nPalette; i++) {
+        out->colorTable[i * 4] = job->palette[i][2];
+        out->colorTable[i * 4 + 1] = job->palette[i][1];
+        out->colorTable[i * 4 + 2] = job->palette[i][0];
+    }
+
+    pthread_mutex_destroy(&job->lock);
+    free(job->histogram);
+    free(job->grid);
+    free(job);
+    if (failed) {
+        printf("Erreur : Allocation memoire echouee pour la quantification.\n");
+        bmp8_free(out);
+        PROFILE_END(quantize_image, 0);
+        return NULL;
+    }
+
+    PROFILE_END(quantize_image, (size_t)img->width * img->height);
+    return out;
+}
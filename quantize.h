@@ -0,0 +1,25 @@
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+#include "bmp8.h"
+#include "bmp24.h"
+
+// Quantification d'une image 24 bits vers une image 8 bits indexée.
+// La palette est construite par coupe médiane sur un histogramme 5 bits
+// par canal, puis une grille 32x32x32 précalculée donne l'index de la
+// couleur la plus proche en O(1) par pixel.
+
+#define QUANTIZE_MAX_COLORS 256
+
+// Tramage appliqué lors de l'affectation des couleurs
+typedef enum {
+    DITHER_NONE,
+    DITHER_ORDERED,         // matrice de Bayer 8x8 (parallélisable)
+    DITHER_FLOYD_STEINBERG  // diffusion d'erreur (séquentielle)
+} t_dither;
+
+// Retourne une nouvelle image 8 bits (en-tête et palette valides pour
+// bmp8_saveImage) d'au plus nColors couleurs, NULL en cas d'échec
+t_bmp8 *quantize_image(t_bmp24 *img, int nColors, t_dither dither);
+
+#endif // QUANTIZE_H
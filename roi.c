@@ -0,0 +1,47 @@
+#include "roi.h"
+
+/**
+ * Restreint une région aux limites d'une image
+ * @param roi Région à restreindre (modifiée)
+ * @param width Largeur de l'image
+ * @param height Hauteur de l'image
+ * @return 0 si la région est non vide, -1 sinon
+ */
+int roi_clip(t_roi *roi, int width, int height) {
+    int x0 = roi->x < 0 ? 0 : roi->x;
+    int y0 = roi->y < 0 ? 0 : roi->y;
+    long long x1 = (long long)roi->x + roi->width;
+    long long y1 = (long long)roi->y + roi->height;
+    if (x1 > width) x1 = width;
+    if (y1 > height) y1 = height;
+
+    if (roi->width <= 0 || roi->height <= 0 || x1 <= x0 || y1 <= y0) {
+        roi->width = 0;
+        roi->height = 0;
+        return -1;
+    }
+    roi->x = x0;
+    roi->y = y0;
+    roi->width = (int)x1 - x0;
+    roi->height = (int)y1 - y0;
+    return 0;
+}
+
+/**
+ * Agrandit une région d'une marge puis la restreint à l'image
+ * @param roi Région d'origine
+ * @param margin Marge ajoutée de chaque côté
+ * @param width Largeur de l'image
+ * @param height Hauteur de l'image
+ * @return Région agrandie (vide si roi ne recoupe pas l'image)
+ */
+t_roi roi_expand(t_roi roi, int margin, int width, int height) {
+    if (roi_clip(&roi, width, height) == 0) {
+        roi.x -= margin;
+        roi.y -= margin;
+        roi.width += 2 * margin;
+        roi.height += 2 * margin;
+        roi_clip(&roi, width, height);
+    }
+    return roi;
+}
@@ -0,0 +1,22 @@
+#ifndef ROI_H
+#define ROI_H
+
+// Région d'intérêt rectangulaire, en pixels. L'origine est le coin en haut
+// à gauche de l'image et y croît vers le bas, quel que soit l'ordre de
+// stockage des lignes (les images 8 bits sont rangées de bas en haut).
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} t_roi;
+
+// Restreint roi à une image width x height. Retourne 0 si la région
+// restante est non vide, -1 sinon.
+int roi_clip(t_roi *roi, int width, int height);
+
+// Région agrandie de margin pixels de chaque côté puis restreinte à l'image
+// (voisinage lu par un noyau de convolution)
+t_roi roi_expand(t_roi roi, int margin, int width, int height);
+
+#endif // ROI_H
@@ -0,0 +1,389 @@
+#include "sequence.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// File de tampons partagée entre le thread de chargement et le traitement
+typedef struct {
+    const t_sequenceOptions *options;
+    int first;
+    pthread_mutex_t lock;               // protège tout ce qui suit
+    pthread_cond_t changed;
+    t_bmp24 *spare[SEQUENCE_BUFFERS];   // tampons rendus (NULL : pas encore alloué)
+    int spareCount;
+    t_bmp24 *ready[SEQUENCE_BUFFERS];   // images chargées, dans l'ordre
+    int readyHead;
+    int readyCount;
+    int finished;                       // plus aucune image à charger
+    int stopping;                       // arrêt demandé par le traitement
+    int loadFailed;                     // image présente mais illisible
+    char failedPath[SEQUENCE_PATH_MAX];
+} t_sequence;
+
+// État des opérations temporelles, mis à jour à chaque image
+typedef struct {
+    const t_sequenceOptions *options;
+    int width;
+    int height;
+    int initialized;
+    float *model;                       // moyenne glissante ou fond, 3 floats par pixel
+    unsigned char *previous;            // image précédente (différence), 3 octets par pixel
+    t_bmp24 *img;                       // image courante
+} t_temporal;
+
+static double sequence_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1e6;
+}
+
+/**
+ * Vérifie qu'un motif de nom contient exactement une conversion entière
+ * (%d, %04d, %i...) et aucune autre, pour pouvoir le passer à snprintf
+ * @return 0 si le motif est valide, -1 sinon
+ */
+static int sequence_checkPattern(const char *pattern) {
+    int conversions = 0;
+    for (const char *c = pattern; *c; c++) {
+        if (*c != '%') continue;
+        c++;
+        if (*c == '%') continue;
+        while (*c == '0' || *c == '-' || *c == '+' || *c == ' ') c++;
+        while (*c >= '0' && *c <= '9') c++;
+        if (*c != 'd' && *c != 'i') return -1;
+        conversions++;
+    }
+    return conversions == 1 ? 0 : -1;
+}
+
+static void sequence_framePath(char *path, const char *pattern, int index) {
+    snprintf(path, SEQUENCE_PATH_MAX, pattern, index);
+}
+
+/**
+ * Valeurs par défaut des options d'une séquence
+ * @param options Options à initialiser
+ */
+void sequence_defaultOptions(t_sequenceOptions *options) {
+    memset(options, 0, sizeof(t_sequenceOptions));
+    options->first = -1;
+    options->count = -1;
+    options->mode = TEMPORAL_NONE;
+    options->alpha = 0.05f;
+    options->threshold = 30;
+}
+
+/**
+ * Lit l'opération temporelle et ses paramètres
+ * @param options Options à compléter
+ * @param text "-", "average[:alpha]", "diff" ou "background[:alpha[:seuil]]"
+ * @return 0 si succès, -1 si le texte est invalide
+ */
+int sequence_parseMode(t_sequenceOptions *options, const char *text) {
+    if (strcmp(text, "-") == 0) {
+        options->mode = TEMPORAL_NONE;
+        return 0;
+    }
+
+    const char *colon = strchr(text, ':');
+    size_t length = colon ? (size_t)(colon - text) : strlen(text);
+    float alpha = options->alpha;
+    long threshold = options->threshold;
+    int parameters = 0;
+    if (colon) {
+        char *end = NULL;
+        alpha = strtof(colon + 1, &end);
+        if (end == colon + 1) return -1;
+        parameters = 1;
+        if (*end == ':') {
+            const char *start = end + 1;
+            threshold = strtol(start, &end, 10);
+            if (end == start) return -1;
+            parameters = 2;
+        }
+        if (*end != '\0') return -1;
+    }
+
+    t_temporalMode mode;
+    if (length == 7 && strncmp(text, "average", 7) == 0 && parameters <= 1) mode = TEMPORAL_AVERAGE;
+    else if (length == 4 && strncmp(text, "diff", 4) == 0 && parameters == 0) mode = TEMPORAL_DIFFERENCE;
+    else if (length == 10 && strncmp(text, "background", 10) == 0) mode = TEMPORAL_BACKGROUND;
+    else return -1;
+
+    if (alpha <= 0.0f || alpha > 1.0f || threshold < 0 || threshold > 255) return -1;
+    options->mode = mode;
+    options->alpha = alpha;
+    options->threshold = (int)threshold;
+    return 0;
+}
+
+// --- Chargement anticipé ---
+
+static void *sequence_loader(void *arg) {
+    t_sequence *seq = (t_sequence *)arg;
+    const t_sequenceOptions *options = seq->options;
+    char path[SEQUENCE_PATH_MAX];
+
+    for (int i = 0; options->count < 0 || i < options->count; i++) {
+        sequence_framePath(path, options->inputPattern, seq->first + i);
+        if (access(path, R_OK) != 0) break;  // fin de la séquence
+
+        pthread_mutex_lock(&seq->lock);
+        while (seq->spareCount == 0 && !seq->stopping) {
+            pthread_cond_wait(&seq->changed, &seq->lock);
+        }
+        if (seq->stopping) {
+            pthread_mutex_unlock(&seq->lock);
+            break;
+        }
+        t_bmp24 *spare = seq->spare[--seq->spareCount];
+        pthread_mutex_unlock(&seq->lock);
+
+        // Les pixels sont relus dans les lignes du tampon recyclé
+        // Seul un fichier absent marque la fin : une image présente mais
+        // illisible (corrompue, tronquée) est une erreur
+        t_bmp24 *img = bmp24_loadImageReuse(path, spare);
+        if (!img) {
+            pthread_mutex_lock(&seq->lock);
+            seq->loadFailed = 1;
+            memcpy(seq->failedPath, path, SEQUENCE_PATH_MAX);
+            pthread_mutex_unlock(&seq->lock);
+            break;
+        }
+
+        pthread_mutex_lock(&seq->lock);
+        seq->ready[(seq->readyHead + seq->readyCount) % SEQUENCE_BUFFERS] = img;
+        seq->readyCount++;
+        pthread_cond_broadcast(&seq->changed);
+        pthread_mutex_unlock(&seq->lock);
+    }
+
+    pthread_mutex_lock(&seq->lock);
+    seq->finished = 1;
+    pthread_cond_broadcast(&seq->changed);
+    pthread_mutex_unlock(&seq->lock);
+    return NULL;
+}
+
+// Image suivante dans l'ordre, NULL en fin de séquence
+static t_bmp24 *sequence_next(t_sequence *seq) {
+    pthread_mutex_lock(&seq->lock);
+    while (seq->readyCount == 0 && !seq->finished) {
+        pthread_cond_wait(&seq->changed, &seq->lock);
+    }
+    t_bmp24 *img = NULL;
+    if (seq->readyCount > 0) {
+        img = seq->ready[seq->readyHead];
+        seq->readyHead = (seq->readyHead + 1) % SEQUENCE_BUFFERS;
+        seq->readyCount--;
+    }
+    pthread_mutex_unlock(&seq->lock);
+    return img;
+}
+
+// Rend un tampon au thread de chargement
+static void sequence_release(t_sequence *seq, t_bmp24 *img) {
+    pthread_mutex_lock(&seq->lock);
+    seq->spare[seq->spareCount++] = img;
+    pthread_cond_broadcast(&seq->changed);
+    pthread_mutex_unlock(&seq->lock);
+}
+
+// --- Opérations temporelles ---
+
+static void sequence_temporalRows(void *ctx, int begin, int end) {
+    t_temporal *state = (t_temporal *)ctx;
+    const t_sequenceOptions *options = state->options;
+    float alpha = options->alpha;
+    int width = state->width;
+
+    for (int y = begin; y < end; y++) {
+        unsigned char *row = (unsigned char *)state->img->data[y];  // t_pixel : 3 octets
+        float *model = state->model ? state->model + (size_t)y * width * 3 : NULL;
+        unsigned char *previous = state->previous ? state->previous + (size_t)y * width * 3 : NULL;
+
+        if (!state->initialized) {
+            // Première image : l'état part de l'image elle-même
+            for (int i = 0; i < width * 3; i++) {
+                if (model) model[i] = row[i];
+                if (previous) previous[i] = row[i];
+                if (options->mode != TEMPORAL_AVERAGE) row[i] = 0;
+            }
+            continue;
+        }
+
+        switch (options->mode) {
+            case TEMPORAL_AVERAGE:
+                for (int i = 0; i < width * 3; i++) {
+                    model[i] += alpha * (row[i] - model[i]);
+                    row[i] = (unsigned char)(model[i] + 0.5f);
+                }
+                break;
+            case TEMPORAL_DIFFERENCE:
+                for (int i = 0; i < width * 3; i++) {
+                    unsigned char value = row[i];
+                    row[i] = (unsigned char)abs(value - previous[i]);
+                    previous[i] = value;
+                }
+                break;
+            case TEMPORAL_BACKGROUND:
+                for (int x = 0; x < width * 3; x += 3) {
+                    int foreground = 0;
+                    for (int c = 0; c < 3; c++) {
+                        float diff = row[x + c] - model[x + c];
+                        if (diff > options->threshold || diff < -options->threshold) foreground = 1;
+                        model[x + c] += alpha * diff;
+                    }
+                    row[x] = row[x + 1] = row[x + 2] = foreground ? 255 : 0;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * Applique l'opération temporelle à l'image courante et met l'état à jour
+ * @return 0 si succès, -1 si les dimensions changent ou en cas d'échec d'allocation
+ */
+static int sequence_temporal(t_temporal *state, t_bmp24 *img) {
+    if (state->options->mode == TEMPORAL_NONE) return 0;
+
+    if (!state->model && !state->previous) {
+        size_t size = (size_t)img->width * img->height * 3;
+        state->width = img->width;
+        state->height = img->height;
+        if (state->options->mode == TEMPORAL_DIFFERENCE) {
+            state->previous = (unsigned char *)malloc(size);
+        } else {
+            state->model = (float *)malloc(size * sizeof(float));
+        }
+        if (!state->model && !state->previous) {
+            printf("Erreur : Allocation memoire echouee pour l'etat temporel\n");
+            return -1;
+        }
+        PROFILE_ALLOC(state->model ? size * sizeof(float) : size);
+    } else if (img->width != state->width || img->height != state->height) {
+        printf("Erreur : Les images de la sequence n'ont pas toutes la meme taille\n");
+        return -1;
+    }
+
+    PROFILE_BEGIN(sequence_temporal);
+    state->img = img;
+    threadpool_parallelFor(0, img->height, 0, sequence_temporalRows, state);
+    state->initialized = 1;
+    PROFILE_END(sequence_temporal, (size_t)img->width * img->height);
+    return 0;
+}
+
+/**
+ * Traite une séquence d'images numérotées : chargement anticipé, opérations
+ * du pipeline, opération temporelle puis sauvegarde, avec affichage du débit
+ * @param options Options de la séquence
+ * @param stats Statistiques à remplir (peut être NULL)
+ * @return 0 si au moins une image a été traitée sans erreur, -1 sinon
+ */
+int sequence_run(const t_sequenceOptions *options, t_sequenceStats *stats) {
+    if (!options || !options->inputPattern || sequence_checkPattern(options->inputPattern) != 0 ||
+        (options->outputPattern && sequence_checkPattern(options->outputPattern) != 0)) {
+        printf("Erreur : Les motifs de noms doivent contenir un seul entier (%%d, %%04d...)\n");
+        return -1;
+    }
+
+    t_sequence seq;
+    memset(&seq, 0, sizeof(seq));
+    seq.options = options;
+    seq.first = options->first;
+    if (seq.first < 0) {
+        char path[SEQUENCE_PATH_MAX];
+        sequence_framePath(path, options->inputPattern, 0);
+        seq.first = access(path, R_OK) == 0 ? 0 : 1;
+    }
+    seq.spareCount = SEQUENCE_BUFFERS;   // tampons alloués au premier chargement
+    pthread_mutex_init(&seq.lock, NULL);
+    pthread_cond_init(&seq.changed, NULL);
+
+    pthread_t loader;
+    if (pthread_create(&loader, NULL, sequence_loader, &seq) != 0) {
+        printf("Erreur : Impossible de lancer le thread de chargement\n");
+        pthread_mutex_destroy(&seq.lock);
+        pthread_cond_destroy(&seq.changed);
+        return -1;
+    }
+
+    t_temporal temporal;
+    memset(&temporal, 0, sizeof(temporal));
+    temporal.options = options;
+    char path[SEQUENCE_PATH_MAX];
+    int frames = 0;
+    int error = 0;
+    double waitMs = 0.0;
+    double start = sequence_now();
+
+    while (!error) {
+        double waitStart = sequence_now();
+        t_bmp24 *img = sequence_next(&seq);
+        waitMs += sequence_now() - waitStart;
+        if (!img) break;
+
+        if (options->ops && strcmp(options->ops, "-") != 0) {
+            t_pipeline *p = pipeline_create24(img);
+            if (!p || pipeline_parse(p, options->ops) != 0) {
+                printf("Erreur : Operations invalides : %s\n", options->ops);
+                error = 1;
+            } else {
+                pipeline_execute(p);
+            }
+            pipeline_free(p);
+        }
+        if (!error && sequence_temporal(&temporal, img) != 0) error = 1;
+        if (!error && options->outputPattern) {
+            sequence_framePath(path, options->outputPattern, seq.first + frames);
+            if (bmp24_saveImage(img, path) != 0) error = 1;
+        }
+        sequence_release(&seq, img);
+        if (error) break;
+
+        frames++;
+        if (frames % SEQUENCE_REPORT_EVERY == 0) {
+            double elapsed = (sequence_now() - start) / 1000.0;
+            printf("Images traitees : %d (%.1f images/s)\n", frames, frames / elapsed);
+        }
+    }
+
+    // Arrêt du chargement puis libération des tampons
+    pthread_mutex_lock(&seq.lock);
+    seq.stopping = 1;
+    pthread_cond_broadcast(&seq.changed);
+    pthread_mutex_unlock(&seq.lock);
+    pthread_join(loader, NULL);
+    if (seq.loadFailed) {
+        printf("Erreur : Image illisible dans la sequence : %s\n", seq.failedPath);
+        error = 1;
+    }
+    for (int i = 0; i < seq.spareCount; i++) bmp24_free(seq.spare[i]);
+    for (int i = 0; i < seq.readyCount; i++) bmp24_free(seq.ready[(seq.readyHead + i) % SEQUENCE_BUFFERS]);
+    pthread_mutex_destroy(&seq.lock);
+    pthread_cond_destroy(&seq.changed);
+    free(temporal.model);
+    free(temporal.previous);
+
+    double seconds = (sequence_now() - start) / 1000.0;
+    double fps = seconds > 0.0 ? frames / seconds : 0.0;
+    printf("Sequence : %d images en %.2f s (%.1f images/s, attente du chargement %.0f ms)\n",
+           frames, seconds, fps, waitMs);
+    if (stats) {
+        stats->frames = frames;
+        stats->seconds = seconds;
+        stats->fps = fps;
+        stats->waitMs = waitMs;
+    }
+    return (frames > 0 && !error) ? 0 : -1;
+}
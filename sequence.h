@@ -0,0 +1,60 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include "bmp24.h"
+
+// Traitement de séquences d'images 24 bits numérotées ("cam/img_%04d.bmp").
+// Un thread de chargement lit les images suivantes pendant le traitement
+// de l'image courante ; les SEQUENCE_BUFFERS tampons circulent entre les
+// deux threads et sont réutilisés d'une image à l'autre (aucune allocation
+// en régime établi tant que les dimensions ne changent pas).
+//
+// Chaque image passe par les opérations du pipeline (syntaxe de
+// pipeline_parse) puis par une opération temporelle dont l'état est mis à
+// jour image par image, sans recalcul sur une fenêtre :
+//   - moyenne glissante exponentielle : m += alpha * (image - m)
+//   - différence avec l'image précédente : |image - précédente|
+//   - soustraction de fond : masque blanc où un canal s'écarte de plus de
+//     threshold du fond, le fond suivant l'image par moyenne glissante.
+
+#define SEQUENCE_BUFFERS 3          // image traitée + images préchargées
+#define SEQUENCE_PATH_MAX 1024
+#define SEQUENCE_REPORT_EVERY 50    // fréquence d'affichage du débit (images)
+
+typedef enum {
+    TEMPORAL_NONE,
+    TEMPORAL_AVERAGE,
+    TEMPORAL_DIFFERENCE,
+    TEMPORAL_BACKGROUND
+} t_temporalMode;
+
+typedef struct {
+    const char *inputPattern;   // motif printf avec un seul entier (%d, %04d...)
+    const char *outputPattern;  // idem, NULL pour ne rien sauvegarder
+    const char *ops;            // opérations du pipeline, NULL si aucune
+    int first;                  // premier numéro, -1 pour 0 ou 1 selon les fichiers présents
+    int count;                  // nombre maximal d'images, -1 jusqu'à la première absente
+    t_temporalMode mode;
+    float alpha;                // facteur de la moyenne glissante (0 < alpha <= 1)
+    int threshold;              // seuil de la soustraction de fond
+} t_sequenceOptions;
+
+typedef struct {
+    int frames;
+    double seconds;
+    double fps;
+    double waitMs;              // temps passé à attendre le chargement
+} t_sequenceStats;
+
+// Valeurs par défaut (pas d'opération temporelle, alpha 0,05, seuil 30)
+void sequence_defaultOptions(t_sequenceOptions *options);
+
+// Lit l'opération temporelle : "-", "average[:alpha]", "diff",
+// "background[:alpha[:seuil]]". Retourne 0 si succès, -1 sinon.
+int sequence_parseMode(t_sequenceOptions *options, const char *text);
+
+// Traite la séquence (bloquant). stats peut être NULL.
+// Retourne 0 si au moins une image a été traitée sans erreur, -1 sinon.
+int sequence_run(const t_sequenceOptions *options, t_sequenceStats *stats);
+
+#endif // SEQUENCE_H
@@ -0,0 +1,400 @@
+#include "server.h"
+#include "bmpheader.h"
+#include "cache.h"
+#include "pipeline.h"
+#include "shared.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Connexion cliente, servie par son propre thread
+typedef struct t_connection {
+    int fd;
+    struct t_server *server;
+    struct t_connection *prev;
+    struct t_connection *next;
+} t_connection;
+
+typedef struct t_server {
+    int listenFd;
+    int stopping;
+    t_cache *cache;
+    pthread_mutex_t lock;        // protège tout ce qui suit
+    pthread_cond_t idle;         // signalé quand la dernière connexion se termine
+    t_connection *connections;
+    int active;
+    double latencies[SERVER_LATENCY_SAMPLES]; // fenêtre circulaire (ms)
+    long long requests;
+    long long errors;
+    t_bmp8 *pool8[SERVER_POOL_SIZE];
+    int count8;
+    t_bmp24 *pool24[SERVER_POOL_SIZE];
+    int count24;
+} t_server;
+
+static double server_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1e6;
+}
+
+static int server_write(int fd, const char *text) {
+    size_t length = strlen(text);
+    while (length > 0) {
+        ssize_t n = send(fd, text, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        text += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * Lit la profondeur de couleur dans l'en-tête validé d'un fichier BMP
+ * @return 8, 24, ou -1 si le fichier est illisible ou invalide
+ */
+static int server_bitDepth(const char *path) {
+    t_bmpFormat format;
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    t_bmpError error = bmpheader_read(file, &format);
+    fclose(file);
+    return error == BMP_OK ? format.bits : -1;
+}
+
+// --- Pool d'images : les tampons des requêtes précédentes sont recyclés ---
+
+static t_bmp8 *pool_take8(t_server *s) {
+    pthread_mutex_lock(&s->lock);
+    t_bmp8 *img = s->count8 ? s->pool8[--s->count8] : NULL;
+    pthread_mutex_unlock(&s->lock);
+    return img;
+}
+
+static t_bmp24 *pool_take24(t_server *s) {
+    pthread_mutex_lock(&s->lock);
+    t_bmp24 *img = s->count24 ? s->pool24[--s->count24] : NULL;
+    pthread_mutex_unlock(&s->lock);
+    return img;
+}
+
+static void pool_give8(t_server *s, t_bmp8 *img) {
+    pthread_mutex_lock(&s->lock);
+    if (s->count8 < SERVER_POOL_SIZE) {
+        s->pool8[s->count8++] = img;
+        img = NULL;
+    }
+    pthread_mutex_unlock(&s->lock);
+    bmp8_free(img);
+}
+
+static void pool_give24(t_server *s, t_bmp24 *img) {
+    pthread_mutex_lock(&s->lock);
+    if (s->count24 < SERVER_POOL_SIZE) {
+        s->pool24[s->count24++] = img;
+        img = NULL;
+    }
+    pthread_mutex_unlock(&s->lock);
+    bmp24_free(img);
+}
+
+// --- Requêtes ---
+
+/**
+ * Traite une requête PROCESS : chargement, opérations (via le cache), sauvegarde
+ * @param reply Réponse à compléter (SERVER_LINE_MAX octets)
+ */
+static void server_process(t_server *s, const char *input, const char *ops, const char *output, char *reply) {
+    double start = server_now();
+    // "shm:<nom>" : l'image est attachée depuis un segment partagé et traitée sur place
+    const char *segment = NULL;
+    if (strncmp(input, SHARED_DESCRIPTOR_PREFIX, strlen(SHARED_DESCRIPTOR_PREFIX)) == 0) {
+        segment = input + strlen(SHARED_DESCRIPTOR_PREFIX);
+    }
+    int depth = segment ? shared_depth(segment) : server_bitDepth(input);
+    if (depth != 8 && depth != 24) {
+        snprintf(reply, SERVER_LINE_MAX, "ERR entree illisible ou non supportee : %s\n", input);
+        pthread_mutex_lock(&s->lock);
+        s->errors++;
+        pthread_mutex_unlock(&s->lock);
+        return;
+    }
+
+    t_bmp8 *img8 = NULL;
+    t_bmp24 *img24 = NULL;
+    t_pipeline *p = NULL;
+    if (depth == 8) {
+        img8 = segment ? shared_attach8(segment) : bmp8_loadImageReuse(input, pool_take8(s));
+        p = pipeline_create8(img8);
+    } else {
+        img24 = segment ? shared_attach24(segment) : bmp24_loadImageReuse(input, pool_take24(s));
+        p = pipeline_create24(img24);
+    }
+
+    int hit = 0;
+    if (!p) {
+        snprintf(reply, SERVER_LINE_MAX, "ERR chargement impossible : %s\n", input);
+    } else if (strcmp(ops, "-") != 0 && pipeline_parse(p, ops) != 0) {
+        snprintf(reply, SERVER_LINE_MAX, "ERR operations invalides : %s\n", ops);
+    } else {
+        hit = cache_execute(s->cache, p);
+        // Sortie "-" pour un segment : le résultat reste dans le segment
+        reply[0] = '\0';
+        if (!segment || strcmp(output, "-") != 0) {
+            int saved = img8 ? bmp8_saveImage(output, img8) : bmp24_saveImage(img24, output);
+            if (saved != 0) snprintf(reply, SERVER_LINE_MAX, "ERR ecriture impossible : %s\n", output);
+        }
+    }
+    pipeline_free(p);
+    if (segment) {
+        shared_detach8(img8);
+        shared_detach24(img24);
+    } else {
+        if (img8) pool_give8(s, img8);
+        if (img24) pool_give24(s, img24);
+    }
+
+    double elapsed = server_now() - start;
+    pthread_mutex_lock(&s->lock);
+    if (reply[0]) {
+        s->errors++;
+    } else {
+        s->latencies[s->requests % SERVER_LATENCY_SAMPLES] = elapsed;
+        s->requests++;
+    }
+    pthread_mutex_unlock(&s->lock);
+    if (!reply[0]) snprintf(reply, SERVER_LINE_MAX, "OK %.2f%s\n", elapsed, hit ? " CACHE" : "");
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/**
+ * Percentiles de latence (rang le plus proche) sur les dernières requêtes
+ */
+static void server_stats(t_server *s, char *reply) {
+    double sorted[SERVER_LATENCY_SAMPLES];
+    pthread_mutex_lock(&s->lock);
+    long long requests = s->requests;
+    long long errors = s->errors;
+    int n = requests < SERVER_LATENCY_SAMPLES ? (int)requests : SERVER_LATENCY_SAMPLES;
+    memcpy(sorted, s->latencies, n * sizeof(double));
+    pthread_mutex_unlock(&s->lock);
+
+    qsort(sorted, n, sizeof(double), compareDouble);
+    double q[3] = {0.50, 0.90, 0.99};
+    double value[3] = {0, 0, 0};
+    for (int i = 0; i < 3 && n > 0; i++) {
+        int rank = (int)(q[i] * n + 0.999999);
+        value[i] = sorted[(rank > 0 ? rank : 1) - 1];
+    }
+    t_cacheStats cache;
+    cache_getStats(s->cache, &cache);
+    snprintf(reply, SERVER_LINE_MAX,
+             "OK requests=%lld errors=%lld p50=%.2f p90=%.2f p99=%.2f max=%.2f cache_hits=%lld cache_misses=%lld\n",
+             requests, errors, value[0], value[1], value[2], n ? sorted[n - 1] : 0.0,
+             cache.memoryHits + cache.diskHits, cache.misses);
+}
+
+static void server_stop(t_server *s) {
+    pthread_mutex_lock(&s->lock);
+    s->stopping = 1;
+    pthread_mutex_unlock(&s->lock);
+    shutdown(s->listenFd, SHUT_RDWR); // débloque accept
+}
+
+static void *server_connection(void *arg) {
+    t_connection *c = (t_connection *)arg;
+    t_server *s = c->server;
+    FILE *in = fdopen(c->fd, "r");
+    char line[SERVER_LINE_MAX];
+    char reply[SERVER_LINE_MAX];
+
+    while (in && fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *save = NULL;
+        char *command = strtok_r(line, " ", &save);
+        if (!command) continue;
+
+        if (strcmp(command, "PROCESS") == 0) {
+            char *input = strtok_r(NULL, " ", &save);
+            char *ops = strtok_r(NULL, " ", &save);
+            char *output = strtok_r(NULL, " ", &save);
+            if (!input || !ops || !output) snprintf(reply, sizeof(reply), "ERR usage : PROCESS <entree> <operations> <sortie>\n");
+            else server_process(s, input, ops, output, reply);
+        } else if (strcmp(command, "STATS") == 0) {
+            server_stats(s, reply);
+        } else if (strcmp(command, "SHUTDOWN") == 0) {
+            server_write(c->fd, "OK\n");
+            server_stop(s);
+            continue;
+        } else {
+            snprintf(reply, sizeof(reply), "ERR commande inconnue : %s\n", command);
+        }
+        if (server_write(c->fd, reply) != 0) break;
+    }
+
+    // Retrait de la liste avant de fermer, pour que server_run ne touche
+    // jamais un descripteur déjà réutilisé
+    pthread_mutex_lock(&s->lock);
+    if (c->prev) c->prev->next = c->next;
+    else s->connections = c->next;
+    if (c->next) c->next->prev = c->prev;
+    s->active--;
+    if (s->active == 0) pthread_cond_signal(&s->idle);
+    pthread_mutex_unlock(&s->lock);
+
+    if (in) fclose(in);
+    else close(c->fd);
+    free(c);
+    return NULL;
+}
+
+/**
+ * Lance le serveur sur une socket Unix
+ * @param socketPath Chemin de la socket (remplacée si elle existe déjà)
+ * @return 0 après un arrêt demandé par SHUTDOWN, -1 en cas d'erreur
+ */
+int server_run(const char *socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        printf("Erreur : Chemin de socket trop long : %s\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    t_server *s = (t_server *)calloc(1, sizeof(t_server));
+    if (!s) {
+        printf("Erreur : Allocation memoire echouee pour le serveur.\n");
+        return -1;
+    }
+    s->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+    if (s->listenFd < 0 || bind(s->listenFd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(s->listenFd, SERVER_BACKLOG) != 0) {
+        printf("Erreur : Impossible d'ecouter sur %s : %s\n", socketPath, strerror(errno));
+        if (s->listenFd >= 0) close(s->listenFd);
+        free(s);
+        return -1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->idle, NULL);
+    s->cache = cache_create(SERVER_CACHE_MEMORY, getenv("PROJETC_CACHE_DIR"), SERVER_CACHE_DISK);
+    printf("Serveur en ecoute sur %s (%d threads de calcul)\n", socketPath, threadpool_threadCount());
+    fflush(stdout);
+
+    for (;;) {
+        int fd = accept(s->listenFd, NULL, NULL);
+        if (fd < 0) {
+            pthread_mutex_lock(&s->lock);
+            int stopping = s->stopping;
+            pthread_mutex_unlock(&s->lock);
+            if (stopping) break;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            printf("Erreur : accept : %s\n", strerror(errno));
+            break;
+        }
+
+        t_connection *c = (t_connection *)calloc(1, sizeof(t_connection));
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        pthread_mutex_lock(&s->lock);
+        if (c) {
+            c->fd = fd;
+            c->server = s;
+            c->next = s->connections;
+            if (s->connections) s->connections->prev = c;
+            s->connections = c;
+            s->active++;
+        }
+        pthread_mutex_unlock(&s->lock);
+        if (c && pthread_create(&thread, &attr, server_connection, c) != 0) {
+            pthread_mutex_lock(&s->lock);
+            s->connections = c->next;
+            if (c->next) c->next->prev = NULL;
+            s->active--;
+            pthread_mutex_unlock(&s->lock);
+            free(c);
+            c = NULL;
+        }
+        pthread_attr_destroy(&attr);
+        if (!c) close(fd);
+    }
+
+    // Arrêt : on coupe la lecture des connexions restantes et on attend leur fin
+    pthread_mutex_lock(&s->lock);
+    for (t_connection *c = s->connections; c; c = c->next) shutdown(c->fd, SHUT_RD);
+    while (s->active > 0) pthread_cond_wait(&s->idle, &s->lock);
+    pthread_mutex_unlock(&s->lock);
+
+    close(s->listenFd);
+    unlink(socketPath);
+    cache_printStats(s->cache);
+    cache_free(s->cache);
+    for (int i = 0; i < s->count8; i++) bmp8_free(s->pool8[i]);
+    for (int i = 0; i < s->count24; i++) bmp24_free(s->pool24[i]);
+    pthread_cond_destroy(&s->idle);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+    return 0;
+}
+
+/**
+ * Envoie une requête au serveur et affiche sa réponse
+ * @param socketPath Chemin de la socket du serveur
+ * @param request Requête (une ligne, sans retour à la ligne)
+ * @return 0 si la réponse est OK, -1 sinon
+ */
+int server_send(const char *socketPath, const char *request) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        printf("Erreur : Chemin de socket trop long : %s\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        printf("Erreur : Connexion impossible a %s : %s\n", socketPath, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int status = -1;
+    if (server_write(fd, request) == 0 && server_write(fd, "\n") == 0) {
+        shutdown(fd, SHUT_WR);
+        char reply[SERVER_LINE_MAX];
+        size_t length = 0;
+        ssize_t n;
+        while (length < sizeof(reply) - 1 && (n = read(fd, reply + length, sizeof(reply) - 1 - length)) > 0) {
+            length += (size_t)n;
+        }
+        reply[length] = '\0';
+        printf("%s", reply);
+        if (strncmp(reply, "OK", 2) == 0) status = 0;
+    }
+    close(fd);
+    return status;
+}
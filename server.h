@@ -0,0 +1,34 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+// Mode serveur : le processus reste résident et traite des requêtes reçues
+// sur une socket Unix locale. Le pool de threads, le cache de résultats et
+// les tampons d'images restent chauds d'une requête à l'autre.
+//
+// Protocole texte, une requête par ligne, une ligne de réponse :
+//   PROCESS <entrée> <opérations> <sortie>  ->  OK <ms> [CACHE] | ERR <message>
+//   STATS                                   ->  OK requests=... p50=... p90=... p99=... max=...
+//   SHUTDOWN                                ->  OK (arrêt du serveur)
+// Les chemins ne doivent pas contenir d'espace ; les opérations suivent la
+// syntaxe de pipeline_parse ("gray,brightness:20,gaussian,threshold:128"),
+// "-" pour une simple copie.
+// L'entrée peut être un segment de mémoire partagée ("shm:/nom", voir
+// shared.h) : l'image est traitée sur place, sans copie ; la sortie "-"
+// laisse alors le résultat dans le segment.
+// Le cache disque est activé par la variable PROJETC_CACHE_DIR.
+
+#define SERVER_LINE_MAX 4096
+#define SERVER_BACKLOG 64
+#define SERVER_LATENCY_SAMPLES 4096              // fenêtre des percentiles
+#define SERVER_POOL_SIZE 8                       // images gardées pour réutilisation
+#define SERVER_CACHE_MEMORY (256u * 1024 * 1024)
+#define SERVER_CACHE_DISK (1024u * 1024 * 1024)
+
+// Lance le serveur (bloquant jusqu'à SHUTDOWN). Retourne 0 si succès.
+int server_run(const char *socketPath);
+
+// Client : envoie une requête et affiche la réponse. Retourne 0 si la
+// réponse commence par OK.
+int server_send(const char *socketPath, const char *request);
+
+#endif // SERVER_H
@@ -0,0 +1,261 @@
+#include "shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// En-tête d'un segment, dans sa première page
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t colorDepth;        // 8 ou 24
+    uint32_t reserved;
+    uint64_t size;             // taille totale du segment
+    unsigned char header[54];  // en-tête BMP (fichier + information)
+    unsigned char colorTable[1024]; // palette (8 bits uniquement)
+} t_sharedHeader;
+
+_Static_assert(sizeof(t_sharedHeader) <= SHARED_DATA_OFFSET, "l'en-tete doit tenir dans la premiere page");
+
+static size_t shared_pixelBytes(int width, int height, int depth) {
+    return (size_t)width * (size_t)height * (depth == 24 ? sizeof(t_pixel) : 1);
+}
+
+/**
+ * Crée et projette un segment
+ * @return Adresse du segment, NULL en cas d'erreur
+ */
+static t_sharedHeader *shared_createSegment(const char *name, int width, int height, int depth) {
+    if (width <= 0 || height <= 0) {
+        printf("Erreur : Dimensions invalides pour le segment %s\n", name);
+        return NULL;
+    }
+    size_t size = SHARED_DATA_OFFSET + shared_pixelBytes(width, height, depth);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        printf("Erreur : Creation du segment %s impossible : %s\n", name, strerror(errno));
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        printf("Erreur : Dimensionnement du segment %s impossible : %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // la projection garde le segment ouvert
+    if (base == MAP_FAILED) {
+        printf("Erreur : Projection du segment %s impossible : %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return NULL;
+    }
+
+    t_sharedHeader *segment = (t_sharedHeader *)base;
+    memset(segment, 0, sizeof(t_sharedHeader));
+    segment->magic = SHARED_MAGIC;
+    segment->version = SHARED_VERSION;
+    segment->width = width;
+    segment->height = height;
+    segment->colorDepth = depth;
+    segment->size = size;
+    return segment;
+}
+
+/**
+ * Projette un segment existant après vérification de son en-tête
+ * @param depth Profondeur attendue (8 ou 24)
+ * @return Adresse du segment, NULL en cas d'erreur
+ */
+static t_sharedHeader *shared_openSegment(const char *name, int depth) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        printf("Erreur : Ouverture du segment %s impossible : %s\n", name, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SHARED_DATA_OFFSET) {
+        printf("Erreur : Segment %s invalide\n", name);
+        close(fd);
+        return NULL;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Erreur : Projection du segment %s impossible : %s\n", name, strerror(errno));
+        return NULL;
+    }
+
+    t_sharedHeader *segment = (t_sharedHeader *)base;
+    if (segment->magic != SHARED_MAGIC || segment->version != SHARED_VERSION ||
+        segment->size != (uint64_t)st.st_size || segment->colorDepth != depth ||
+        segment->width <= 0 || segment->height <= 0 ||
+        SHARED_DATA_OFFSET + shared_pixelBytes(segment->width, segment->height, depth) > segment->size) {
+        printf("Erreur : Segment %s invalide ou de profondeur differente de %d bits\n", name, depth);
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    return segment;
+}
+
+// Construit la vue t_bmp24 d'un segment : les lignes pointent dans les pixels partagés
+static t_bmp24 *shared_view24(t_sharedHeader *segment) {
+    t_bmp24 *img = (t_bmp24 *)malloc(sizeof(t_bmp24));
+    t_pixel **rows = (t_pixel **)malloc(segment->height * sizeof(t_pixel *));
+    if (!img || !rows) {
+        printf("Erreur : Allocation memoire echouee\n");
+        free(img);
+        free(rows);
+        munmap(segment, segment->size);
+        return NULL;
+    }
+    t_pixel *pixels = (t_pixel *)((unsigned char *)segment + SHARED_DATA_OFFSET);
+    for (int y = 0; y < segment->height; y++) {
+        rows[y] = pixels + (size_t)y * segment->width;
+    }
+    img->width = segment->width;
+    img->height = segment->height;
+    img->colorDepth = 24;
+    img->data = rows;
+    memcpy(&img->header, segment->header, sizeof(t_bmp_header));
+    memcpy(&img->header_info, segment->header + sizeof(t_bmp_header), sizeof(t_bmp_info));
+    return img;
+}
+
+// Construit la vue t_bmp8 d'un segment : les pixels restent dans le segment
+static t_bmp8 *shared_view8(t_sharedHeader *segment) {
+    t_bmp8 *img = (t_bmp8 *)malloc(sizeof(t_bmp8));
+    if (!img) {
+        printf("Erreur : Allocation memoire echouee\n");
+        munmap(segment, segment->size);
+        return NULL;
+    }
+    img->width = segment->width;
+    img->height = segment->height;
+    img->colorDepth = 8;
+    img->dataSize = img->width * img->height;
+    img->data = (unsigned char *)segment + SHARED_DATA_OFFSET;
+    memcpy(img->header, segment->header, sizeof(img->header));
+    memcpy(img->colorTable, segment->colorTable, sizeof(img->colorTable));
+    return img;
+}
+
+/**
+ * Crée une image 24 bits dans un nouveau segment de mémoire partagée
+ * @param name Nom du segment (commence par '/')
+ * @param width Largeur
+ * @param height Hauteur
+ * @return Image attachée (pixels non initialisés), NULL en cas d'erreur
+ */
+t_bmp24 *shared_create24(const char *name, int width, int height) {
+    t_sharedHeader *segment = shared_createSegment(name, width, height, 24);
+    if (!segment) return NULL;
+    t_bmp24 *img = shared_view24(segment);
+    if (!img) {
+        shm_unlink(name);
+        return NULL;
+    }
+    bmp24_initHeaders(img);
+    memcpy(segment->header, &img->header, sizeof(t_bmp_header));
+    memcpy(segment->header + sizeof(t_bmp_header), &img->header_info, sizeof(t_bmp_info));
+    return img;
+}
+
+/**
+ * Crée une image 8 bits (palette de gris) dans un nouveau segment
+ * @param name Nom du segment (commence par '/')
+ * @param width Largeur
+ * @param height Hauteur
+ * @return Image attachée (pixels non initialisés), NULL en cas d'erreur
+ */
+t_bmp8 *shared_create8(const char *name, unsigned int width, unsigned int height) {
+    t_sharedHeader *segment = shared_createSegment(name, (int)width, (int)height, 8);
+    if (!segment) return NULL;
+    t_bmp8 *img = shared_view8(segment);
+    if (!img) {
+        shm_unlink(name);
+        return NULL;
+    }
+    bmp8_initHeader(img);
+    memcpy(segment->header, img->header, sizeof(img->header));
+    memcpy(segment->colorTable, img->colorTable, sizeof(img->colorTable));
+    return img;
+}
+
+/**
+ * Attache l'image 24 bits d'un segment existant (sans copie des pixels)
+ * @param name Nom du segment
+ * @return Image attachée, NULL en cas d'erreur
+ */
+t_bmp24 *shared_attach24(const char *name) {
+    t_sharedHeader *segment = shared_openSegment(name, 24);
+    return segment ? shared_view24(segment) : NULL;
+}
+
+/**
+ * Attache l'image 8 bits d'un segment existant (sans copie des pixels)
+ * @param name Nom du segment
+ * @return Image attachée, NULL en cas d'erreur
+ */
+t_bmp8 *shared_attach8(const char *name) {
+    t_sharedHeader *segment = shared_openSegment(name, 8);
+    return segment ? shared_view8(segment) : NULL;
+}
+
+/**
+ * Lit la profondeur de l'image d'un segment sans l'attacher durablement
+ * @return 8, 24 ou -1 si le segment est absent ou invalide
+ */
+int shared_depth(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return -1;
+    t_sharedHeader header;
+    ssize_t n = read(fd, &header, sizeof(header));
+    close(fd);
+    if (n != (ssize_t)sizeof(header) || header.magic != SHARED_MAGIC || header.version != SHARED_VERSION) return -1;
+    return (header.colorDepth == 8 || header.colorDepth == 24) ? header.colorDepth : -1;
+}
+
+/**
+ * Publie les en-têtes dans le segment puis détache l'image 24 bits
+ * @param img Image obtenue par shared_create24 ou shared_attach24
+ */
+void shared_detach24(t_bmp24 *img) {
+    if (!img || !img->data) return;
+    t_sharedHeader *segment = (t_sharedHeader *)((unsigned char *)img->data[0] - SHARED_DATA_OFFSET);
+    memcpy(segment->header, &img->header, sizeof(t_bmp_header));
+    memcpy(segment->header + sizeof(t_bmp_header), &img->header_info, sizeof(t_bmp_info));
+    munmap(segment, segment->size);
+    free(img->data);
+    free(img);
+}
+
+/**
+ * Publie l'en-tête et la palette dans le segment puis détache l'image 8 bits
+ * @param img Image obtenue par shared_create8 ou shared_attach8
+ */
+void shared_detach8(t_bmp8 *img) {
+    if (!img || !img->data) return;
+    t_sharedHeader *segment = (t_sharedHeader *)(img->data - SHARED_DATA_OFFSET);
+    memcpy(segment->header, img->header, sizeof(img->header));
+    memcpy(segment->colorTable, img->colorTable, sizeof(img->colorTable));
+    munmap(segment, segment->size);
+    free(img);
+}
+
+/**
+ * Supprime un segment
+ * @return 0 si succès, -1 sinon
+ */
+int shared_destroy(const char *name) {
+    if (shm_unlink(name) != 0) {
+        printf("Erreur : Suppression du segment %s impossible : %s\n", name, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
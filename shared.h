@@ -0,0 +1,45 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include "bmp8.h"
+#include "bmp24.h"
+
+// Images en mémoire partagée POSIX (shm_open), pour passer des images
+// entre processus sans fichier ni copie. Un segment est autodescriptif :
+// une page d'en-tête (dimensions, profondeur, en-têtes BMP, palette) puis
+// les pixels. Le descripteur à transmettre est simplement le nom du
+// segment ("/projetc-camera-0"), préfixé par "shm:" dans les requêtes du
+// serveur.
+//
+// Les lignes d'une t_bmp24 attachée pointent directement dans le segment :
+// tous les traitements travaillent sur place. Une image attachée se libère
+// avec shared_detach24 / shared_detach8, jamais avec bmp24_free / bmp8_free.
+// La synchronisation entre producteur et consommateur reste à la charge
+// des processus (un seul écrivain à la fois).
+
+#define SHARED_DESCRIPTOR_PREFIX "shm:"
+#define SHARED_MAGIC 0x4D534A50u    // "PJSM"
+#define SHARED_VERSION 1
+#define SHARED_DATA_OFFSET 4096     // les pixels commencent à la deuxième page
+
+// Créent un segment (erreur s'il existe déjà) et l'attachent
+t_bmp24 *shared_create24(const char *name, int width, int height);
+t_bmp8 *shared_create8(const char *name, unsigned int width, unsigned int height);
+
+// Attachent un segment existant
+t_bmp24 *shared_attach24(const char *name);
+t_bmp8 *shared_attach8(const char *name);
+
+// Profondeur (8 ou 24) de l'image d'un segment, -1 si illisible
+int shared_depth(const char *name);
+
+// Republient les en-têtes (et la palette en 8 bits, modifiée par les
+// opérations ponctuelles) dans le segment puis détachent l'image.
+// Le segment continue d'exister.
+void shared_detach24(t_bmp24 *img);
+void shared_detach8(t_bmp8 *img);
+
+// Supprime le segment (les processus encore attachés le gardent jusqu'au détachement)
+int shared_destroy(const char *name);
+
+#endif // SHARED_H
@@ -0,0 +1,138 @@
+#!/bin/sh
+# Test du mode serveur (lancé par ctest) : démarre --serve, envoie des
+# requêtes PROCESS concurrentes, vérifie les réponses, le cache, STATS
+# puis l'arrêt par SHUTDOWN.
+# Usage : server_test.sh <executable ProjetC>
+
+PROGRAM="$1"
+if [ ! -x "$PROGRAM" ]; then
+    echo "Erreur : executable introuvable : $PROGRAM"
+    exit 1
+fi
+
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/projetc_server.XXXXXX") || exit 1
+SOCKET="$WORK/serveur.sock"
+SERVER_PID=""
+FAILURES=0
+
+cleanup() {
+    if [ -n "$SERVER_PID" ]; then kill "$SERVER_PID" 2>/dev/null; fi
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "ECHEC : $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+# Entier sur 4 octets, petit-boutiste
+le32() {
+    printf "\\$(printf %03o $(($1 & 255)))\\$(printf %03o $((($1 >> 8) & 255)))"
+    printf "\\$(printf %03o $((($1 >> 16) & 255)))\\$(printf %03o $((($1 >> 24) & 255)))"
+}
+
+# Image 24 bits 16x16 (dégradé), sans dépendance externe
+make_bmp() {
+    {
+        printf 'BM'; le32 822; le32 0; le32 54
+        le32 40; le32 16; le32 16; printf '\001\000\030\000'
+        le32 0; le32 768; le32 2835; le32 2835; le32 0; le32 0
+        y=0
+        while [ $y -lt 16 ]; do
+            x=0
+            while [ $x -lt 16 ]; do
+                printf "\\$(printf %03o $((x * 16)))\\$(printf %03o $((y * 16)))\\$(printf %03o $((x * 8 + y * 8)))"
+                x=$((x + 1))
+            done
+            y=$((y + 1))
+        done
+    } > "$1"
+}
+
+make_bmp "$WORK/entree.bmp"
+
+"$PROGRAM" --serve "$SOCKET" > "$WORK/serveur.log" 2>&1 &
+SERVER_PID=$!
+tries=0
+while [ ! -S "$SOCKET" ] && [ $tries -lt 50 ]; do
+    sleep 0.1
+    tries=$((tries + 1))
+done
+if [ ! -S "$SOCKET" ]; then
+    echo "ECHEC : le serveur n'a pas cree la socket"
+    cat "$WORK/serveur.log"
+    exit 1
+fi
+
+# 1. Requêtes concurrentes : toutes doivent réussir et produire leur sortie
+CLIENTS=8
+CLIENT_PIDS=""
+i=0
+while [ $i -lt $CLIENTS ]; do
+    "$PROGRAM" --send "$SOCKET" PROCESS "$WORK/entree.bmp" gray,brightness:20,gaussian "$WORK/sortie_$i.bmp" \
+        > "$WORK/reponse_$i.txt" &
+    CLIENT_PIDS="$CLIENT_PIDS $!"
+    i=$((i + 1))
+done
+for pid in $CLIENT_PIDS; do wait "$pid"; done
+i=0
+while [ $i -lt $CLIENTS ]; do
+    grep -q '^OK' "$WORK/reponse_$i.txt" || fail "PROCESS concurrent $i : $(cat "$WORK/reponse_$i.txt")"
+    cmp -s "$WORK/sortie_0.bmp" "$WORK/sortie_$i.bmp" || fail "sortie $i differente de la sortie 0"
+    i=$((i + 1))
+done
+
+# 2. Même requête une fois les premières terminées : servie par le cache
+reply=$("$PROGRAM" --send "$SOCKET" PROCESS "$WORK/entree.bmp" gray,brightness:20,gaussian "$WORK/sortie_cache.bmp")
+case "$reply" in
+    OK*CACHE*) ;;
+    *) fail "requete repetee non servie par le cache : $reply" ;;
+esac
+cmp -s "$WORK/sortie_0.bmp" "$WORK/sortie_cache.bmp" || fail "sortie du cache differente"
+
+# 3. Erreurs : entrée absente, commande inconnue
+reply=$("$PROGRAM" --send "$SOCKET" PROCESS "$WORK/absente.bmp" gray "$WORK/x.bmp")
+case "$reply" in
+    ERR*) ;;
+    *) fail "entree absente acceptee : $reply" ;;
+esac
+reply=$("$PROGRAM" --send "$SOCKET" INCONNUE)
+case "$reply" in
+    ERR*) ;;
+    *) fail "commande inconnue acceptee : $reply" ;;
+esac
+
+# 4. STATS : requêtes réussies, erreurs (l'entrée absente) et percentiles
+reply=$("$PROGRAM" --send "$SOCKET" STATS)
+expected=$((CLIENTS + 1))
+echo "$reply" | grep -q "^OK requests=$expected errors=1 " || fail "compteurs STATS : $reply"
+echo "$reply" | grep -q "cache_hits=[1-9]" || fail "aucun succes de cache dans STATS : $reply"
+p50=$(echo "$reply" | sed -n 's/.* p50=\([0-9.]*\) .*/\1/p')
+p99=$(echo "$reply" | sed -n 's/.* p99=\([0-9.]*\) .*/\1/p')
+if [ -z "$p50" ] || [ -z "$p99" ] || [ "$(echo "$p50 $p99" | awk '{print ($1 <= $2)}')" != 1 ]; then
+    fail "percentiles incoherents : $reply"
+fi
+
+# 5. SHUTDOWN : réponse OK puis fin du processus serveur avec le code 0
+reply=$("$PROGRAM" --send "$SOCKET" SHUTDOWN)
+[ "$reply" = "OK" ] || fail "SHUTDOWN : $reply"
+tries=0
+while kill -0 "$SERVER_PID" 2>/dev/null && [ $tries -lt 50 ]; do
+    sleep 0.1
+    tries=$((tries + 1))
+done
+if kill -0 "$SERVER_PID" 2>/dev/null; then
+    fail "le serveur ne s'arrete pas apres SHUTDOWN"
+else
+    wait "$SERVER_PID" || fail "code de sortie du serveur non nul"
+    SERVER_PID=""
+fi
+
+if [ $FAILURES -ne 0 ]; then
+    echo "--- journal du serveur ---"
+    cat "$WORK/serveur.log"
+    exit 1
+fi
+echo "Serveur : tous les tests passent"
+exit 0
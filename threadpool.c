@@ -0,0 +1,309 @@
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h> // pour sysconf
+
+// Groupe de tâches d'un même parallelFor
+typedef struct {
+    atomic_int pending;
+} t_taskGroup;
+
+typedef struct {
+    t_rangeTask fn;
+    void *ctx;
+    int begin;
+    int end;
+    t_taskGroup *group;
+} t_task;
+
+// File double : le propriétaire travaille en bas, les voleurs prennent en haut.
+// Les indices croissent indéfiniment et sont ramenés à la capacité (puissance de 2).
+typedef struct {
+    pthread_mutex_t lock;
+    t_task *tasks;
+    int capacity;
+    int top;
+    int bottom;
+} t_deque;
+
+static struct {
+    int nThreads;   // appelant compris
+    int nWorkers;   // threads créés par le pool
+    int nDeques;    // une file par worker, la dernière est partagée par les threads extérieurs
+    t_deque *deques;
+    pthread_mutex_t sleepLock;
+    pthread_cond_t wake;
+    int sleeping;
+    atomic_int queued;
+} pool;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static atomic_int pool_static = 0;             // répartition statique (mesures)
+static _Thread_local int pool_self = -1;       // file du thread courant (-1 : extérieur)
+static _Thread_local unsigned int pool_seed = 0; // choix pseudo-aléatoire des victimes
+
+static int deque_push(t_deque *d, const t_task *task) {
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom - d->top == d->capacity) {
+        int capacity = d->capacity ? d->capacity * 2 : 64;
+        t_task *tasks = (t_task *)malloc(capacity * sizeof(t_task));
+        if (!tasks) {
+            pthread_mutex_unlock(&d->lock);
+            return -1;
+        }
+        for (int i = d->top; i < d->bottom; i++) {
+            tasks[i & (capacity - 1)] = d->tasks[i & (d->capacity - 1)];
+        }
+        free(d->tasks);
+        d->tasks = tasks;
+        d->capacity = capacity;
+    }
+    d->tasks[d->bottom & (d->capacity - 1)] = *task;
+    d->bottom++;
+    pthread_mutex_unlock(&d->lock);
+    return 0;
+}
+
+static int deque_pop(t_deque *d, t_task *task) {
+    int found = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) {
+        d->bottom--;
+        *task = d->tasks[d->bottom & (d->capacity - 1)];
+        found = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+static int deque_steal(t_deque *d, t_task *task) {
+    int found = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) {
+        *task = d->tasks[d->top & (d->capacity - 1)];
+        d->top++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+/**
+ * Prend une tâche : d'abord dans sa propre file, sinon chez un autre thread
+ * @param self Index de la file du thread courant
+ * @param task Tâche récupérée
+ * @return 1 si une tâche a été trouvée
+ */
+static int pool_take(int self, t_task *task) {
+    if (atomic_load(&pool.queued) == 0) return 0;
+
+    int found = deque_pop(&pool.deques[self], task);
+    int nDeques = pool.nDeques;
+    if (!found) {
+        pool_seed = pool_seed * 1103515245u + 12345u;
+        int start = (int)((pool_seed >> 16) % (unsigned int)nDeques);
+        for (int i = 0; i < nDeques && !found; i++) {
+            int victim = (start + i) % nDeques;
+            if (victim != self) found = deque_steal(&pool.deques[victim], task);
+        }
+    }
+    if (found) atomic_fetch_sub(&pool.queued, 1);
+    return found;
+}
+
+static void pool_run(const t_task *task) {
+    task->fn(task->ctx, task->begin, task->end);
+    atomic_fetch_sub(&task->group->pending, 1);
+}
+
+static void *pool_worker(void *arg) {
+    pool_self = (int)(size_t)arg;
+    pool_seed = (unsigned int)pool_self * 2654435761u + 1;
+    for (;;) {
+        t_task task;
+        if (pool_take(pool_self, &task)) {
+            pool_run(&task);
+            continue;
+        }
+        pthread_mutex_lock(&pool.sleepLock);
+        while (atomic_load(&pool.queued) == 0) {
+            pool.sleeping++;
+            pthread_cond_wait(&pool.wake, &pool.sleepLock);
+            pool.sleeping--;
+        }
+        pthread_mutex_unlock(&pool.sleepLock);
+    }
+    return NULL;
+}
+
+static void pool_init(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *env = getenv("PROJETC_THREADS");
+    if (env && atoi(env) > 0) n = atoi(env);
+    if (n < 1) n = 1;
+
+    pthread_mutex_init(&pool.sleepLock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+    atomic_init(&pool.queued, 0);
+    pool.nThreads = 1;
+    pool.nWorkers = 0;
+
+    pool.deques = (t_deque *)calloc(n, sizeof(t_deque));
+    if (!pool.deques) return;
+    for (long i = 0; i < n; i++) {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+    }
+    pool.nDeques = (int)n;
+
+    // Les workers sont démarrés une fois pour toutes (détachés)
+    for (long i = 0; i < n - 1; i++) {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (pthread_create(&thread, &attr, pool_worker, (void *)(size_t)i) != 0) {
+            pthread_attr_destroy(&attr);
+            break;
+        }
+        pthread_attr_destroy(&attr);
+        pool.nWorkers++;
+    }
+    pool.nThreads = pool.nWorkers + 1;
+}
+
+/**
+ * Nombre de threads participant aux calculs, appelant compris
+ */
+int threadpool_threadCount(void) {
+    pthread_once(&pool_once, pool_init);
+    return pool.nThreads;
+}
+
+void threadpool_setStaticPartition(int enabled) {
+    atomic_store(&pool_static, enabled != 0);
+}
+
+// Tranche fixe d'une répartition statique
+typedef struct {
+    t_rangeTask fn;
+    void *ctx;
+    int begin;
+    int end;
+    int grain;      // morceaux imposés par l'appelant (<= 0 : un seul appel)
+} t_slice;
+
+static void *pool_sliceThread(void *arg) {
+    t_slice *slice = (t_slice *)arg;
+    if (slice->grain <= 0) {
+        slice->fn(slice->ctx, slice->begin, slice->end);
+        return NULL;
+    }
+    for (int b = slice->begin; b < slice->end; b += slice->grain) {
+        slice->fn(slice->ctx, b, (b + slice->grain < slice->end) ? b + slice->grain : slice->end);
+    }
+    return NULL;
+}
+
+/**
+ * Répartition statique : nThreads tranches contiguës de même taille, une
+ * par thread (l'appelant prend la première), puis attente de toutes. Un
+ * grain explicite est respecté : les morceaux sont répartis en bloc.
+ */
+static void pool_staticFor(int begin, int end, int grain, int nThreads, t_rangeTask fn, void *ctx) {
+    int step = grain > 0 ? grain : 1;
+    int units = (end - begin + step - 1) / step;
+    if (nThreads > units) nThreads = units;
+    t_slice *slices = (t_slice *)malloc(nThreads * sizeof(t_slice));
+    pthread_t *threads = (pthread_t *)malloc(nThreads * sizeof(pthread_t));
+    int *started = (int *)calloc(nThreads, sizeof(int));
+    if (!slices || !threads || !started) {
+        free(slices);
+        free(threads);
+        free(started);
+        t_slice all = {fn, ctx, begin, end, grain};
+        pool_sliceThread(&all);
+        return;
+    }
+
+    for (int i = 0; i < nThreads; i++) {
+        long long first = begin + (long long)units * i / nThreads * step;
+        long long last = begin + (long long)units * (i + 1) / nThreads * step;
+        slices[i] = (t_slice){fn, ctx, (int)first, last < end ? (int)last : end, grain};
+    }
+    for (int i = 1; i < nThreads; i++) {
+        started[i] = pthread_create(&threads[i], NULL, pool_sliceThread, &slices[i]) == 0;
+        if (!started[i]) pool_sliceThread(&slices[i]);
+    }
+    pool_sliceThread(&slices[0]);
+    for (int i = 1; i < nThreads; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    free(slices);
+    free(threads);
+    free(started);
+}
+
+/**
+ * Exécution parallèle d'une boucle sur [begin, end)
+ * @param begin Début de la plage
+ * @param end Fin de la plage (exclue)
+ * @param grain Taille maximale d'un morceau (<= 0 : automatique)
+ * @param fn Fonction appelée sur chaque morceau
+ * @param ctx Contexte transmis à fn
+ */
+void threadpool_parallelFor(int begin, int end, int grain, t_rangeTask fn, void *ctx) {
+    if (end <= begin) return;
+    int nThreads = threadpool_threadCount();
+    if (atomic_load(&pool_static) && nThreads > 1) {
+        pool_staticFor(begin, end, grain, nThreads, fn, ctx);
+        return;
+    }
+    if (grain <= 0) {
+        grain = (end - begin) / (4 * nThreads);
+        if (grain < 1) grain = 1;
+    }
+    int chunks = (end - begin + grain - 1) / grain;
+    if (nThreads == 1 || chunks == 1 || !pool.deques) {
+        fn(ctx, begin, end);
+        return;
+    }
+
+    // Les threads extérieurs au pool partagent la dernière file
+    int self = pool_self >= 0 ? pool_self : pool.nDeques - 1;
+    t_taskGroup group;
+    atomic_init(&group.pending, chunks - 1);
+
+    // Le premier morceau est exécuté directement, les autres sont publiés
+    // du dernier au premier pour que le propriétaire les reprenne dans l'ordre
+    int published = 0;
+    for (int c = chunks - 1; c >= 1; c--) {
+        int b = begin + c * grain;
+        int e = (b + grain < end) ? b + grain : end;
+        t_task task = {fn, ctx, b, e, &group};
+        atomic_fetch_add(&pool.queued, 1);
+        if (deque_push(&pool.deques[self], &task) != 0) {
+            atomic_fetch_sub(&pool.queued, 1);
+            fn(ctx, b, e); // mémoire épuisée : exécution directe
+            atomic_fetch_sub(&group.pending, 1);
+            continue;
+        }
+        published++;
+    }
+    if (published) {
+        pthread_mutex_lock(&pool.sleepLock);
+        if (pool.sleeping) pthread_cond_broadcast(&pool.wake);
+        pthread_mutex_unlock(&pool.sleepLock);
+    }
+
+    fn(ctx, begin, (begin + grain < end) ? begin + grain : end);
+
+    // En attendant les morceaux volés, on aide au lieu de bloquer
+    while (atomic_load(&group.pending) > 0) {
+        t_task task;
+        if (pool_take(self, &task)) pool_run(&task);
+        else sched_yield();
+    }
+}
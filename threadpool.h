@@ -0,0 +1,28 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Pool de threads à vol de tâches (work stealing) partagé par tous les
+// traitements. Chaque thread a sa propre file : il dépile ses tâches par
+// le bas (LIFO) et les threads inoccupés volent par le haut (FIFO). Un
+// thread qui attend la fin d'un parallelFor exécute des tâches au lieu de
+// bloquer, ce qui rend l'imbrication (lot d'images, chacune découpée en
+// tuiles) sûre sans jamais créer plus de threads que de cœurs.
+
+// Fonction exécutée sur la plage [begin, end)
+typedef void (*t_rangeTask)(void *ctx, int begin, int end);
+
+// Exécute fn sur [begin, end) découpé en morceaux d'au plus grain
+// éléments (grain <= 0 : découpage automatique) et attend la fin
+void threadpool_parallelFor(int begin, int end, int grain, t_rangeTask fn, void *ctx);
+
+// Nombre de threads participant aux calculs (appelant compris). Fixé au
+// premier appel, depuis la variable d'environnement PROJETC_THREADS ou
+// le nombre de cœurs.
+int threadpool_threadCount(void);
+
+// Répartition statique, pour les mesures de référence (bench.h) : chaque
+// parallelFor est coupé en threadCount tranches égales, exécutées par des
+// threads créés pour l'appel, sans vol de tâches. Désactivée par défaut.
+void threadpool_setStaticPartition(int enabled);
+
+#endif // THREADPOOL_H